@@ -26864,11 +26864,11 @@ namespace ia32
 	
 	_LINKAGE void monitor( any_ptr adr, uint32_t extensions, uint32_t hints )
 	{
-		__builtin_ia32_monitor( ( void* ) adr, extensions, hints );
+		asm volatile( "monitor" :: "a" ( ( void* ) adr ), "c" ( extensions ), "d" ( hints ) : "memory" );
 	}
 	_LINKAGE void mwait( uint32_t extensions, uint32_t hints )
 	{
-		__builtin_ia32_mwait( extensions, hints );
+		asm volatile( "mwait" :: "c" ( extensions ), "a" ( hints ) : "memory" );
 	}
 	_LINKAGE void umonitor( void* adr )
 	{
@@ -27007,7 +27007,14 @@ namespace ia32
 	_LINKAGE CONST_FN constexpr uint32_t crc32ci( T value, uint32_t crc = ~0 )
 	{
 		if ( !std::is_constant_evaluated() )
+		{
+#if XSTD_HW_CRC32C_DYNAMIC
+			if ( xstd::impl::hw_crc32c_supported() )
+				return xstd::impl::hw_crc32ci( ( const uint8_t* ) &value, sizeof( T ), crc );
+#else
 			return xstd::impl::hw_crc32ci( value, crc );
+#endif
+		}
 
 		xstd::crc32c h{ ~crc };
 		h.add_bytes( value );
@@ -27015,6 +27022,14 @@ namespace ia32
 	}
 	_LINKAGE PURE_FN uint32_t crc32ci( const volatile void* _ptr, size_t length, uint32_t crc = ~0 )
 	{
+#if XSTD_HW_CRC32C_DYNAMIC
+		if ( !xstd::impl::hw_crc32c_supported() )
+		{
+			xstd::crc32c h{ ~crc };
+			h.add_bytes( ( const uint8_t* ) _ptr, length );
+			return ~h.digest();
+		}
+#endif
 		return xstd::impl::hw_crc32ci( ( const uint8_t* ) _ptr, length, crc );
 	}
 	template<xstd::Integral T>
@@ -27253,6 +27268,69 @@ namespace ia32
 		iv[ 4 ] = E0[ 3 ];
 	}
 
+	// Two-way interleaved SHA1, running two independent blocks through the pipeline at once
+	// to hide the latency of the dependent sha1rnds4 chain.
+	//
+	_LINKAGE void sha1_compress_x2( uint32_t* const* iv, const uint8_t* const* block )
+	{
+		auto load_bevec = []( const void* ptr ) FORCE_INLINE {
+			auto bytes = xstd::load_misaligned<v16b_u>( ptr );
+			bytes = __builtin_shufflevector( bytes, bytes, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 );
+			return ( v4d_u ) bytes;
+		};
+
+		struct stream
+		{
+			v4d_u ABCD, ABCD_SAVE, E0, E0_SAVE, E1;
+			v4d_u MSG[ 4 ];
+		} s[ 2 ];
+
+		/* Load initial values */
+		for ( size_t n = 0; n != 2; n++ )
+		{
+			v4d_u ABCD = xstd::load_misaligned<v4d_u>( iv[ n ] );
+			s[ n ].ABCD = s[ n ].ABCD_SAVE = __builtin_shufflevector( ABCD, ABCD, 3, 2, 1, 0 );
+			s[ n ].E0 = s[ n ].E0_SAVE = v4d_u{ 0, 0, 0, iv[ n ][ 4 ] };
+		}
+
+		/* Rounds 4*G to 4*G+3 */
+		xstd::make_constant_series<20>( [ & ] <int G> ( xstd::const_tag<G> ) FORCE_INLINE
+		{
+			auto round = [ & ] ( stream& st, const uint8_t* data ) FORCE_INLINE
+			{
+				auto& MSG = st.MSG;
+				auto& EA = ( G % 2 ) ? st.E1 : st.E0;
+				auto& EB = ( G % 2 ) ? st.E0 : st.E1;
+				if constexpr ( G < 4 )
+					MSG[ G ] = load_bevec( &data[ G * 16 ] );
+
+				if constexpr ( G == 0 )
+					EA += MSG[ 0 ];
+				else
+					EA = sha1nexte( EA, MSG[ G % 4 ] );
+				EB = st.ABCD;
+				if constexpr ( 3 <= G && G <= 18 )
+					MSG[ ( G + 1 ) % 4 ] = sha1msg2( MSG[ ( G + 1 ) % 4 ], MSG[ G % 4 ] );
+				st.ABCD = sha1rnds4<G / 5>( st.ABCD, EA );
+				if constexpr ( 1 <= G && G <= 16 )
+					MSG[ ( G + 3 ) % 4 ] = sha1msg1( MSG[ ( G + 3 ) % 4 ], MSG[ G % 4 ] );
+				if constexpr ( 2 <= G && G <= 17 )
+					MSG[ ( G + 2 ) % 4 ] ^= MSG[ G % 4 ];
+			};
+			round( s[ 0 ], block[ 0 ] );
+			round( s[ 1 ], block[ 1 ] );
+		} );
+
+		/* Combine and save state */
+		for ( size_t n = 0; n != 2; n++ )
+		{
+			v4d_u E0 =   sha1nexte( s[ n ].E0, s[ n ].E0_SAVE );
+			v4d_u ABCD = s[ n ].ABCD + s[ n ].ABCD_SAVE;
+			xstd::store_misaligned<v4d_u>( iv[ n ], __builtin_shufflevector( ABCD, ABCD, 3, 2, 1, 0 ) );
+			iv[ n ][ 4 ] = E0[ 3 ];
+		}
+	}
+
 	// SHA-256 implementation.
 	//
 	_LINKAGE void sha256_compress( uint32_t* iv, const uint8_t* block, const uint32_t* ik_const )
@@ -27436,6 +27514,67 @@ namespace ia32
 		xstd::store_misaligned<v4d_u>( &iv[ 4 ], __builtin_shufflevector( TMP, STATE1, 1, 0, 5, 4 ) ); // BAFE
 	}
 
+	// Two-way interleaved SHA-256, running two independent blocks through the pipeline at once
+	// to hide the latency of the dependent sha256rnds2 chain.
+	//
+	_LINKAGE void sha256_compress_x2( uint32_t* const* iv, const uint8_t* const* block, const uint32_t* ik_const )
+	{
+		auto load_bevec = []( const void* ptr ) FORCE_INLINE {
+			auto bytes = xstd::load_misaligned<v16b_u>( ptr );
+			bytes = __builtin_shufflevector( bytes, bytes, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+			return ( v4d_u ) bytes;
+		};
+
+		struct stream
+		{
+			v4d_u STATE0, STATE1, ABEF_SAVE, CDGH_SAVE;
+			v4d_u MSG[ 4 ];
+		} s[ 2 ];
+
+		/* Load initial values */
+		for ( size_t n = 0; n != 2; n++ )
+		{
+			v4d_u TMP =    xstd::load_misaligned<v4d_u>( &iv[ n ][ 0 ] );
+			v4d_u STATE1 = xstd::load_misaligned<v4d_u>( &iv[ n ][ 4 ] );
+			s[ n ].STATE0 = s[ n ].ABEF_SAVE = __builtin_shufflevector( TMP, STATE1, 5, 4, 1, 0 ); // ABEF
+			s[ n ].STATE1 = s[ n ].CDGH_SAVE = __builtin_shufflevector( TMP, STATE1, 7, 6, 3, 2 ); // CDGH
+		}
+
+		/* Rounds 4*G to 4*G+3 */
+		xstd::make_constant_series<16>( [ & ] <int G> ( xstd::const_tag<G> ) FORCE_INLINE
+		{
+			auto round = [ & ] ( stream& st, const uint8_t* data ) FORCE_INLINE
+			{
+				auto& MSG = st.MSG;
+				if constexpr ( G < 4 )
+					MSG[ G ] = load_bevec( &data[ G * 16 ] );
+
+				v4d_u RND = MSG[ G % 4 ] - xstd::load_misaligned<v4d_u>( &ik_const[ G * 4 ] );
+				st.STATE1 = sha256rnds2( st.STATE1, st.STATE0, RND );
+				if constexpr ( 3 <= G && G <= 14 )
+				{
+					v4d_u TMP = __builtin_shufflevector( MSG[ ( G + 3 ) % 4 ], MSG[ G % 4 ], 1, 2, 3, 4 );
+					MSG[ ( G + 1 ) % 4 ] = sha256msg2( MSG[ ( G + 1 ) % 4 ] + TMP, MSG[ G % 4 ] );
+				}
+				RND = __builtin_shufflevector( RND, RND, 2, 3, 0, 0 );
+				st.STATE0 = sha256rnds2( st.STATE0, st.STATE1, RND );
+				if constexpr ( 1 <= G && G <= 12 )
+					MSG[ ( G + 3 ) % 4 ] = sha256msg1( MSG[ ( G + 3 ) % 4 ], MSG[ G % 4 ] );
+			};
+			round( s[ 0 ], block[ 0 ] );
+			round( s[ 1 ], block[ 1 ] );
+		} );
+
+		/* Combine and save state */
+		for ( size_t n = 0; n != 2; n++ )
+		{
+			v4d_u STATE0 = s[ n ].STATE0 + s[ n ].ABEF_SAVE;
+			v4d_u STATE1 = s[ n ].STATE1 + s[ n ].CDGH_SAVE;
+			xstd::store_misaligned<v4d_u>( &iv[ n ][ 0 ], __builtin_shufflevector( STATE0, STATE1, 3, 2, 7, 6 ) ); // DCHG
+			xstd::store_misaligned<v4d_u>( &iv[ n ][ 4 ], __builtin_shufflevector( STATE0, STATE1, 1, 0, 5, 4 ) ); // BAFE
+		}
+	}
+
 	// Non-temporal memory helpers.
 	//
 	template<typename Vec>
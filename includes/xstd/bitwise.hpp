@@ -15,7 +15,11 @@
 	#define XSTD_HW_BITSCAN   ( __has_builtin(__builtin_ctz) || ( AMD64_TARGET && MS_COMPILER ) )
 #endif
 #ifndef XSTD_HW_PDEP_PEXT
-	#define XSTD_HW_PDEP_PEXT ( AMD64_TARGET && ( GNU_COMPILER || MS_COMPILER ) )
+	#if AMD64_TARGET && ( defined( __BMI2__ ) || MS_COMPILER )
+		#define XSTD_HW_PDEP_PEXT 1
+	#else
+		#define XSTD_HW_PDEP_PEXT 0
+	#endif
 #endif
 
 using bitcnt_t = int;
@@ -0,0 +1,558 @@
+#pragma once
+#include "type_helpers.hpp"
+#include "coro.hpp"
+#include "job.hpp"
+#include "task.hpp"
+#include "future.hpp"
+#include <tuple>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <vector>
+#include <ranges>
+#include <variant>
+#include <optional>
+#include <stop_token>
+
+namespace xstd
+{
+	namespace impl
+	{
+		// Resolves the awaiter of a co_await expression and its result type.
+		//
+		template<typename A>
+		inline decltype( auto ) get_awaiter( A&& a )
+		{
+			if constexpr ( requires { std::forward<A>( a ).operator co_await(); } )
+				return std::forward<A>( a ).operator co_await();
+			else if constexpr ( requires { operator co_await( std::forward<A>( a ) ); } )
+				return operator co_await( std::forward<A>( a ) );
+			else
+				return std::forward<A>( a );
+		}
+		template<typename A>
+		using await_result_t = decltype( get_awaiter( std::declval<A>() ).await_resume() );
+		template<typename A>
+		using child_result_t = std::conditional_t<Void<await_result_t<A>>, std::monostate, std::decay_t<await_result_t<A>>>;
+
+		// Futures with a status can be detached from on cancellation.
+		//
+		template<typename A>
+		concept DetachableFuture = requires( std::remove_reference_t<A>& f, coroutine_handle<> h ) {
+			f.listen( h );
+			f.unlisten( h );
+			f.address()->result;
+		} && std::remove_cvref_t<decltype( std::declval<A&>().address()->result )>::has_status;
+
+		template<typename R>
+		inline R cancelled_result()
+		{
+			if constexpr ( Same<typename R::status_type, xstd::exception> )
+				return R{ in_place_failure_t{}, XSTD_ESTR( "Promise cancelled." ) };
+			else
+				return R{};
+		}
+		template<typename R>
+		inline bool is_failure( const R& result )
+		{
+			if constexpr ( is_specialization_v<basic_result, R> )
+				if constexpr ( R::has_status )
+					return result.fail();
+			return false;
+		}
+
+		// Runner lifetime as seen by the detach path, a runner only finishes while it is not being detached.
+		//
+		enum runner_state : uint8_t
+		{
+			runner_running,
+			runner_finished,
+			runner_detaching,
+		};
+
+		// State shared by the children of a combinator, lives in the awaiting frame.
+		//  - Remaining : children + 1 for the parent while it is starting them.
+		//  - Exception : first exception thrown by a child, rethrown to the parent.
+		//
+		struct join_state
+		{
+			static constexpr size_t npos = SIZE_MAX;
+
+			std::atomic<size_t>     remaining = 0;
+			std::atomic<size_t>     winner = npos;
+			std::atomic<bool>       stopped = false;
+			std::atomic<bool>       faulted = false;
+			bool                    first_wins = false;
+			std::stop_source        source = std::stop_source{ std::nostopstate };
+			std::exception_ptr      exception = nullptr;
+			coroutine_handle<>      continuation = nullptr;
+			void( *detach )( join_state* ) = nullptr;
+
+			// Requests cancellation of the children that have not finished yet.
+			//
+			void cancel()
+			{
+				if ( stopped.exchange( true ) )
+					return;
+				std::atomic_thread_fence( std::memory_order::seq_cst );
+				source.request_stop();
+				if ( detach )
+					detach( this );
+			}
+
+			// Records the completion of a child.
+			//
+			void settle( size_t index, bool failed )
+			{
+				if ( first_wins )
+				{
+					size_t expected = npos;
+					if ( winner.compare_exchange_strong( expected, index ) )
+						cancel();
+				}
+				else if ( failed )
+				{
+					cancel();
+				}
+			}
+
+			// Records the exception of a child and cancels the rest, rethrown once every child is done.
+			//
+			void fail( std::exception_ptr ex )
+			{
+				if ( !faulted.exchange( true ) )
+					exception = std::move( ex );
+				cancel();
+			}
+			void rethrow_if_failed()
+			{
+				if ( exception ) [[unlikely]]
+					std::rethrow_exception( exception );
+			}
+
+			// Drops a reference, returns the continuation if it was the last one.
+			//
+			coroutine_handle<> arrive()
+			{
+				if ( remaining.fetch_sub( 1, std::memory_order::acq_rel ) == 1 )
+					return continuation;
+				return noop_coroutine();
+			}
+		};
+
+		// Runner coroutine, frames are recycled through the promise frame cache.
+		//
+		struct join_runner
+		{
+			struct promise_type
+			{
+				join_state*                state = nullptr;
+				std::atomic<runner_state>* lifetime = nullptr;
+
+				struct final_awaitable
+				{
+					inline bool await_ready() noexcept { return false; }
+					inline coroutine_handle<> await_suspend( coroutine_handle<promise_type> hnd ) noexcept
+					{
+						// Wait out a concurrent detach before the frame is recycled.
+						//
+						auto* st = hnd.promise().state;
+						if ( auto* lt = hnd.promise().lifetime )
+						{
+							runner_state expected = runner_running;
+							while ( !lt->compare_exchange_weak( expected, runner_finished, std::memory_order::acq_rel ) )
+							{
+								expected = runner_running;
+								yield_cpu();
+							}
+						}
+						hnd.destroy();
+						return st->arrive();
+					}
+					inline void await_resume() const noexcept {}
+				};
+
+				void* operator new( size_t n ) { return frame_alloc( n ); }
+				void operator delete( void* p ) { frame_free( p ); }
+
+				join_runner get_return_object() { return { coroutine_handle<promise_type>::from_promise( *this ) }; }
+				suspend_always initial_suspend() noexcept { return {}; }
+				final_awaitable final_suspend() noexcept { return {}; }
+				void return_void() {}
+#if XSTD_NO_EXCEPTIONS
+				XSTDC_UNHANDLED_RETHROW;
+#else
+				void unhandled_exception() { state->fail( std::current_exception() ); }
+#endif
+			};
+			coroutine_handle<promise_type> handle;
+
+			// Binds the runner to the state and returns the handle, the lifetime is tracked if it may be detached.
+			//
+			coroutine_handle<> bind( join_state* st, std::atomic<runner_state>* lifetime = nullptr ) const
+			{
+				handle.promise().state = st;
+				handle.promise().lifetime = lifetime;
+				return handle;
+			}
+		};
+
+		// Awaits a future while allowing the combinator to take the continuation back.
+		//
+		template<typename A>
+		struct detachable_awaitable
+		{
+			using result_type = std::remove_cvref_t<decltype( std::declval<A&>().address()->result )>;
+
+			std::remove_reference_t<A>& future;
+			join_state*                 state;
+
+			inline bool await_ready() { return future.finished(); }
+			inline bool await_suspend( coroutine_handle<> hnd )
+			{
+				// Frame might be resumed as soon as we listen, use the locals.
+				//
+				auto& f = future;
+				auto* st = state;
+				if ( !f.listen( hnd ) )
+					return false;
+				std::atomic_thread_fence( std::memory_order::seq_cst );
+				if ( st->stopped.load( std::memory_order::relaxed ) && f.unlisten( hnd ) )
+					return false;
+				return true;
+			}
+			inline result_type await_resume()
+			{
+				if ( !future.finished() )
+					return cancelled_result<result_type>();
+				auto& result = const_cast< result_type& >( future.address()->unrace() );
+				if constexpr ( is_specialization_v<unique_future, std::remove_cvref_t<A>> )
+					return std::move( result );
+				else
+					return result;
+			}
+		};
+		// Takes the runner back from a pending future, skipping runners that finished as their frames may be reused.
+		//
+		template<typename A>
+		inline void detach_child( A& child, coroutine_handle<> runner, std::atomic<runner_state>& lifetime )
+		{
+			if constexpr ( DetachableFuture<A> )
+			{
+				runner_state expected = runner_running;
+				if ( !lifetime.compare_exchange_strong( expected, runner_detaching, std::memory_order::acq_rel ) )
+					return;
+				bool detached = child.unlisten( runner );
+				lifetime.store( runner_running, std::memory_order::release );
+				if ( detached )
+					runner.resume();
+			}
+		}
+
+		template<typename A, typename R>
+		inline join_runner join_child( join_state* st, size_t index, A&& child, std::optional<R>* out )
+		{
+			if constexpr ( DetachableFuture<A> )
+			{
+				out->emplace( co_await detachable_awaitable<A>{ child, st } );
+			}
+			else if constexpr ( Void<await_result_t<A>> )
+			{
+				co_await std::forward<A>( child );
+				out->emplace();
+			}
+			else
+			{
+				out->emplace( co_await std::forward<A>( child ) );
+			}
+			st->settle( index, is_failure( **out ) );
+		}
+
+		template<typename A>
+		concept Awaitable = requires { typename await_result_t<A>; };
+		template<typename R>
+		using range_child_t = std::conditional_t<std::is_lvalue_reference_v<R>, std::ranges::range_reference_t<R>, std::ranges::range_value_t<R>>;
+		template<typename R>
+		concept AwaitableRange = std::ranges::sized_range<R> && !Awaitable<R> && Awaitable<range_child_t<R>>;
+
+		// Combinator over a fixed list of children.
+		//
+		template<bool Any, typename... Tx>
+		struct join_awaitable : join_state
+		{
+			std::tuple<Tx...>                                children;
+			std::tuple<std::optional<child_result_t<Tx>>...> results;
+			std::array<coroutine_handle<>, sizeof...( Tx )>  runners = {};
+			std::array<std::atomic<runner_state>, sizeof...( Tx )> lifetimes = {};
+
+			join_awaitable( std::stop_source src, Tx&&... children ) : children( std::forward<Tx>( children )... )
+			{
+				first_wins = Any;
+				source = std::move( src );
+			}
+			join_awaitable( join_awaitable&& ) = delete;
+			join_awaitable& operator=( join_awaitable&& ) = delete;
+
+			static void detach_all( join_state* st )
+			{
+				auto* self = static_cast<join_awaitable*>( st );
+				[ & ]<size_t... I>( std::index_sequence<I...> ) {
+					( detach_child( std::get<I>( self->children ), self->runners[ I ], self->lifetimes[ I ] ), ... );
+				}( std::index_sequence_for<Tx...>{} );
+			}
+
+			inline bool await_ready() const noexcept { return sizeof...( Tx ) == 0; }
+			inline coroutine_handle<> await_suspend( coroutine_handle<> hnd )
+			{
+				continuation = hnd;
+				remaining.store( sizeof...( Tx ) + 1, std::memory_order::relaxed );
+				if constexpr ( ( DetachableFuture<Tx> || ... ) )
+					detach = &detach_all;
+				[ & ]<size_t... I>( std::index_sequence<I...> ) {
+					( ( runners[ I ] = join_child( this, I, static_cast< Tx&& >( std::get<I>( children ) ), &std::get<I>( results ) ).bind( this, DetachableFuture<Tx> ? &lifetimes[ I ] : nullptr ) ), ... );
+				}( std::index_sequence_for<Tx...>{} );
+				for ( auto runner : runners )
+					runner.resume();
+				return arrive();
+			}
+			inline auto await_resume()
+			{
+				rethrow_if_failed();
+				return [ & ]<size_t... I>( std::index_sequence<I...> ) {
+					if constexpr ( Any )
+					{
+						using V = std::variant<child_result_t<Tx>...>;
+						using F = V( * )( join_awaitable* );
+						constexpr F table[] = { +[]( join_awaitable* self ) { return V{ std::in_place_index<I>, std::move( *std::get<I>( self->results ) ) }; }... };
+						size_t index = winner.load( std::memory_order::relaxed );
+						return std::pair<size_t, V>{ index, table[ index ]( this ) };
+					}
+					else
+					{
+						return std::tuple<child_result_t<Tx>...>{ std::move( *std::get<I>( results ) )... };
+					}
+				}( std::index_sequence_for<Tx...>{} );
+			}
+		};
+
+		// Combinator over a range of children, rvalue ranges are moved into the awaitable.
+		//
+		template<bool Any, typename A>
+		struct join_range_awaitable : join_state
+		{
+			using value_type = std::remove_reference_t<A>;
+
+			std::vector<std::remove_const_t<value_type>>  owned;
+			std::vector<value_type*>                      children;
+			std::vector<std::optional<child_result_t<A>>> results;
+			std::vector<coroutine_handle<>>               runners;
+			std::unique_ptr<std::atomic<runner_state>[]>  lifetimes;
+
+			template<typename R>
+			join_range_awaitable( std::stop_source src, R&& range )
+			{
+				first_wins = Any;
+				source = std::move( src );
+				if constexpr ( !std::is_reference_v<A> )
+				{
+					owned.reserve( std::ranges::size( range ) );
+					for ( auto&& child : range )
+						owned.emplace_back( std::move( child ) );
+				}
+				auto&& list = [ & ] () -> auto&& {
+					if constexpr ( std::is_reference_v<A> )
+						return range;
+					else
+						return owned;
+				}();
+				children.reserve( std::ranges::size( list ) );
+				for ( auto&& child : list )
+					children.emplace_back( &child );
+				results.resize( children.size() );
+			}
+			join_range_awaitable( join_range_awaitable&& ) = delete;
+			join_range_awaitable& operator=( join_range_awaitable&& ) = delete;
+
+			static void detach_all( join_state* st )
+			{
+				auto* self = static_cast<join_range_awaitable*>( st );
+				for ( size_t n = 0; n != self->children.size(); n++ )
+					detach_child( *self->children[ n ], self->runners[ n ], self->lifetimes[ n ] );
+			}
+
+			inline bool await_ready() const noexcept { return children.empty(); }
+			inline coroutine_handle<> await_suspend( coroutine_handle<> hnd )
+			{
+				continuation = hnd;
+				remaining.store( children.size() + 1, std::memory_order::relaxed );
+				if constexpr ( DetachableFuture<A> )
+				{
+					detach = &detach_all;
+					lifetimes = std::make_unique<std::atomic<runner_state>[]>( children.size() );
+				}
+				runners.resize( children.size() );
+				for ( size_t n = 0; n != children.size(); n++ )
+					runners[ n ] = join_child( this, n, static_cast< A&& >( *children[ n ] ), &results[ n ] ).bind( this, lifetimes ? &lifetimes[ n ] : nullptr );
+				for ( auto runner : runners )
+					runner.resume();
+				return arrive();
+			}
+			inline auto await_resume()
+			{
+				rethrow_if_failed();
+				if constexpr ( Any )
+				{
+					size_t index = winner.load( std::memory_order::relaxed );
+					if ( index == npos )
+						return std::pair<size_t, std::optional<child_result_t<A>>>{ npos, std::nullopt };
+					return std::pair<size_t, std::optional<child_result_t<A>>>{ index, std::move( results[ index ] ) };
+				}
+				else
+				{
+					std::vector<child_result_t<A>> out;
+					out.reserve( results.size() );
+					for ( auto& result : results )
+						out.emplace_back( std::move( *result ) );
+					return out;
+				}
+			}
+		};
+
+		// Bounded-concurrency iteration, each lane pulls the next index until the range is exhausted or cancelled.
+		//
+		template<typename R, typename F>
+		struct for_each_awaitable : join_state
+		{
+			using reference = std::ranges::range_reference_t<R>;
+			static constexpr bool takes_token = std::is_invocable_v<F&, reference, std::stop_token>;
+
+			R                   range;
+			F                   fn;
+			size_t              count;
+			size_t              lanes;
+			std::atomic<size_t> next = 0;
+
+			for_each_awaitable( std::stop_source src, R&& range, size_t concurrency, F&& fn )
+				: range( std::forward<R>( range ) ), fn( std::forward<F>( fn ) )
+			{
+				count = std::ranges::size( this->range );
+				lanes = std::min( std::max<size_t>( concurrency, 1 ), count );
+				if ( takes_token && !src.stop_possible() )
+					src = std::stop_source{};
+				source = std::move( src );
+			}
+			for_each_awaitable( for_each_awaitable&& ) = delete;
+			for_each_awaitable& operator=( for_each_awaitable&& ) = delete;
+
+			inline decltype( auto ) invoke( size_t index )
+			{
+				auto&& item = std::ranges::begin( range )[ index ];
+				if constexpr ( takes_token )
+					return fn( item, source.get_token() );
+				else
+					return fn( item );
+			}
+			static join_runner lane( for_each_awaitable* self )
+			{
+				while ( !self->stopped.load( std::memory_order::relaxed ) )
+				{
+					size_t index = self->next.fetch_add( 1, std::memory_order::relaxed );
+					if ( index >= self->count )
+						break;
+					using result_type = await_result_t<decltype( self->invoke( index ) )>;
+					if constexpr ( Void<result_type> )
+					{
+						co_await self->invoke( index );
+					}
+					else
+					{
+						auto result = co_await self->invoke( index );
+						if ( is_failure( result ) )
+							self->cancel();
+					}
+				}
+			}
+
+			inline bool await_ready() const noexcept { return lanes == 0; }
+			inline coroutine_handle<> await_suspend( coroutine_handle<> hnd )
+			{
+				continuation = hnd;
+				remaining.store( lanes + 1, std::memory_order::relaxed );
+				for ( size_t n = 0; n != lanes; n++ )
+					lane( this ).bind( this ).resume();
+				return arrive();
+			}
+			inline bool await_resume()
+			{
+				rethrow_if_failed();
+				return !stopped.load( std::memory_order::relaxed );
+			}
+		};
+	};
+
+	// Awaits every child, started all at once, resulting in a tuple (or vector for ranges) of their results.
+	// - A failed result requests a stop on the source and detaches from the pending futures.
+	// - A thrown exception stops the rest the same way and is rethrown once every child is done.
+	//
+	template<typename... Tx> requires ( impl::Awaitable<Tx> && ... )
+	inline impl::join_awaitable<false, Tx...> when_all( std::stop_source source, Tx&&... children )
+	{
+		return { std::move( source ), std::forward<Tx>( children )... };
+	}
+	template<typename... Tx> requires ( impl::Awaitable<Tx> && ... )
+	inline impl::join_awaitable<false, Tx...> when_all( Tx&&... children )
+	{
+		return { std::stop_source{ std::nostopstate }, std::forward<Tx>( children )... };
+	}
+	template<impl::AwaitableRange R>
+	inline impl::join_range_awaitable<false, impl::range_child_t<R>> when_all( std::stop_source source, R&& children )
+	{
+		return { std::move( source ), std::forward<R>( children ) };
+	}
+	template<impl::AwaitableRange R>
+	inline impl::join_range_awaitable<false, impl::range_child_t<R>> when_all( R&& children )
+	{
+		return { std::stop_source{ std::nostopstate }, std::forward<R>( children ) };
+	}
+
+	// Awaits the first child to complete, resulting in its index and result. Requests a stop on the source and
+	// detaches from the pending futures once there is a winner, returns after every child is done.
+	// - A thrown exception stops the rest and is rethrown in place of the result.
+	//
+	template<typename... Tx> requires ( sizeof...( Tx ) != 0 && ( impl::Awaitable<Tx> && ... ) )
+	inline impl::join_awaitable<true, Tx...> when_any( std::stop_source source, Tx&&... children )
+	{
+		return { std::move( source ), std::forward<Tx>( children )... };
+	}
+	template<typename... Tx> requires ( sizeof...( Tx ) != 0 && ( impl::Awaitable<Tx> && ... ) )
+	inline impl::join_awaitable<true, Tx...> when_any( Tx&&... children )
+	{
+		return { std::stop_source{ std::nostopstate }, std::forward<Tx>( children )... };
+	}
+	template<impl::AwaitableRange R>
+	inline impl::join_range_awaitable<true, impl::range_child_t<R>> when_any( std::stop_source source, R&& children )
+	{
+		return { std::move( source ), std::forward<R>( children ) };
+	}
+	template<impl::AwaitableRange R>
+	inline impl::join_range_awaitable<true, impl::range_child_t<R>> when_any( R&& children )
+	{
+		return { std::stop_source{ std::nostopstate }, std::forward<R>( children ) };
+	}
+
+	// Invokes fn on every item with at most the given number of them in flight, fn may take a stop token as
+	// its second argument. A failed result stops the iteration, resulting in false.
+	// - A thrown exception stops the iteration and is rethrown once the lanes in flight are done.
+	//
+	template<typename R, typename F> requires ( std::ranges::random_access_range<R> && std::ranges::sized_range<R> )
+	inline impl::for_each_awaitable<R, F> for_each_async( std::stop_source source, R&& range, size_t concurrency, F&& fn )
+	{
+		return { std::move( source ), std::forward<R>( range ), concurrency, std::forward<F>( fn ) };
+	}
+	template<typename R, typename F> requires ( std::ranges::random_access_range<R> && std::ranges::sized_range<R> )
+	inline impl::for_each_awaitable<R, F> for_each_async( R&& range, size_t concurrency, F&& fn )
+	{
+		return { std::stop_source{ std::nostopstate }, std::forward<R>( range ), concurrency, std::forward<F>( fn ) };
+	}
+};
@@ -2,7 +2,9 @@
 #include <type_traits>
 #include <functional>
 #include <utility>
+#include <exception>
 #include "intrinsics.hpp"
+#include "type_helpers.hpp"
 
 #if HAS_MS_EXTENSIONS && CLANG_COMPILER
 	#define XSTD_HAS_STD_CORO 0
@@ -25,8 +27,10 @@
 	
 #if XSTD_NO_EXCEPTIONS
 	#define XSTDC_UNHANDLED_RETHROW void unhandled_exception() {}
+	#define XSTDC_UNHANDLED_FORWARD( slot ) void unhandled_exception() {}
 #else
 	#define XSTDC_UNHANDLED_RETHROW void unhandled_exception() { debugbreak(); std::rethrow_exception( std::current_exception() ); }
+	#define XSTDC_UNHANDLED_FORWARD( slot ) void unhandled_exception() { if ( slot ) *slot = std::current_exception(); else { debugbreak(); std::rethrow_exception( std::current_exception() ); } }
 #endif
 
 namespace xstd
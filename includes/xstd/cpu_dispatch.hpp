@@ -0,0 +1,136 @@
+#pragma once
+#include <string_view>
+#include "intrinsics.hpp"
+#include "type_helpers.hpp"
+#include "xvector.hpp"
+
+// [[Configuration]]
+// XSTD_CPU_DISPATCH: Enables runtime selection of the vectorized kernels by the host CPU, on top of the compile-time target.
+//                    Enabled by default when building for a target below AVX-512.
+//
+#ifndef XSTD_CPU_DISPATCH
+	#if AMD64_TARGET && GNU_COMPILER && XSTD_VECTOR_EXT && !( __AVX512F__ && __AVX512BW__ && __AVX512DQ__ && __AVX512VL__ )
+		#define XSTD_CPU_DISPATCH 1
+	#else
+		#define XSTD_CPU_DISPATCH 0
+	#endif
+#endif
+
+#if XSTD_CPU_DISPATCH
+	// Target attributes of each level, matching x86-64-v3 and x86-64-v4.
+	//
+	#define XSTD_TARGET_AVX2   __attribute__(( target( "avx,avx2,bmi,bmi2,fma,f16c,lzcnt,movbe,popcnt" ) ))
+	#define XSTD_TARGET_AVX512 __attribute__(( target( "avx,avx2,bmi,bmi2,fma,f16c,lzcnt,movbe,popcnt,avx512f,avx512bw,avx512cd,avx512dq,avx512vl" ) ))
+
+	// Kernels instantiated for the wider clones pass 32 and 64-byte vectors between always-inlined helpers, which GCC
+	// reports as an ABI change against the baseline target. The warning is silenced for the dispatch declarations only,
+	// the ones GCC raises while inlining at the end of the translation unit are outside any scope and are left to the
+	// -Wno-psabi passed by the CMake target.
+	//
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace xstd
+{
+	// ISA levels the dispatched kernels are compiled for.
+	//
+	enum class isa_level : uint8_t
+	{
+		generic = 0, // Anything below x86-64-v3, including non-x86 targets.
+		avx2 =    1, // x86-64-v3.
+		avx512 =  2, // x86-64-v4.
+	};
+	inline constexpr std::string_view isa_level_name( isa_level level )
+	{
+		switch ( level )
+		{
+			case isa_level::avx2:   return "avx2";
+			case isa_level::avx512: return "avx512";
+			default:                return "generic";
+		}
+	}
+
+	// Level of the compile-time target.
+	//
+#if AMD64_TARGET && __AVX512F__ && __AVX512BW__ && __AVX512DQ__ && __AVX512VL__
+	inline constexpr isa_level compiled_isa_level = isa_level::avx512;
+#elif AMD64_TARGET && __AVX2__
+	inline constexpr isa_level compiled_isa_level = isa_level::avx2;
+#else
+	inline constexpr isa_level compiled_isa_level = isa_level::generic;
+#endif
+
+	namespace impl
+	{
+#if XSTD_CPU_DISPATCH
+		// Queries the highest level supported by both the processor and the operating system, the remaining features
+		// of each level (lzcnt, movbe, f16c) are implied by the ones checked on every processor shipping them.
+		//
+		inline isa_level detect_isa_level()
+		{
+			__builtin_cpu_init();
+			if ( !__builtin_cpu_supports( "avx2" ) || !__builtin_cpu_supports( "bmi" ) || !__builtin_cpu_supports( "bmi2" ) ||
+				 !__builtin_cpu_supports( "fma" ) || !__builtin_cpu_supports( "popcnt" ) )
+				return isa_level::generic;
+			if ( !__builtin_cpu_supports( "avx512f" ) || !__builtin_cpu_supports( "avx512bw" ) || !__builtin_cpu_supports( "avx512cd" ) ||
+				 !__builtin_cpu_supports( "avx512dq" ) || !__builtin_cpu_supports( "avx512vl" ) )
+				return isa_level::avx2;
+			return isa_level::avx512;
+		}
+
+		// Cached level, reads before the dynamic initialization safely observe the generic level.
+		//
+		inline isa_level host_isa_level = detect_isa_level();
+
+		template<typename F>
+		XSTD_TARGET_AVX2 NO_INLINE inline decltype( auto ) invoke_avx2( F& f ) { return f( const_tag<size_t( 32 )>{} ); }
+		template<typename F>
+		XSTD_TARGET_AVX512 NO_INLINE inline decltype( auto ) invoke_avx512( F& f ) { return f( const_tag<size_t( 64 )>{} ); }
+#endif
+	};
+
+	// Returns the level the dispatched kernels run at on this host.
+	//
+	inline isa_level active_isa_level()
+	{
+#if XSTD_CPU_DISPATCH
+		return std::max( compiled_isa_level, impl::host_isa_level );
+#else
+		return compiled_isa_level;
+#endif
+	}
+
+	// Invokes the functor with the widest SIMD width in bytes the host supports as a const_tag, inlined into a copy
+	// compiled for the matching level. The functor should be FORCE_INLINE so that the kernel is compiled at each level.
+	// If wide is false, such as for inputs too short to benefit, the compile-time width is used without the call.
+	//
+	template<typename F>
+	FORCE_INLINE inline decltype( auto ) simd_dispatch( F&& f, [[maybe_unused]] bool wide = true )
+	{
+#if XSTD_CPU_DISPATCH
+		if constexpr ( XSTD_SIMD_WIDTH < 64 )
+		{
+			if ( wide && impl::host_isa_level == isa_level::avx512 )
+				return impl::invoke_avx512( f );
+		}
+		if constexpr ( XSTD_SIMD_WIDTH < 32 )
+		{
+			if ( wide && impl::host_isa_level == isa_level::avx2 )
+				return impl::invoke_avx2( f );
+		}
+#endif
+		return f( const_tag<size_t( XSTD_SIMD_WIDTH )>{} );
+	}
+
+	// Returns the vector width in bytes the dispatched kernels run with on this host.
+	//
+	inline size_t active_simd_width()
+	{
+		return simd_dispatch( [ ] <auto W> ( const_tag<W> ) FORCE_INLINE { return size_t( W ); } );
+	}
+};
+
+#if XSTD_CPU_DISPATCH
+	#pragma GCC diagnostic pop
+#endif
@@ -3,6 +3,7 @@
 #include <array>
 #include <functional>
 #include <cstring>
+#include <bit>
 #include "intrinsics.hpp"
 #include "type_helpers.hpp"
 #include "bitwise.hpp"
@@ -10,27 +11,83 @@
 
 // [[Configuration]]
 // XSTD_HW_CRC32C: Determines the availability of hardware CRC32C.
+// XSTD_HW_CLMUL:  Determines the availability of hardware carry-less multiplication (PCLMULQDQ / PMULL).
 //
 #ifndef XSTD_HW_CRC32C
 	#define XSTD_HW_CRC32C ( ( AMD64_TARGET || ARM64_TARGET ) && ( GNU_COMPILER || MS_COMPILER ) )
 #endif
+#ifndef XSTD_HW_CLMUL
+	#if ( AMD64_TARGET && ( defined( __PCLMUL__ ) || MS_COMPILER ) ) || ( ARM64_TARGET && defined( __ARM_FEATURE_CRYPTO ) )
+		#define XSTD_HW_CLMUL 1
+	#else
+		#define XSTD_HW_CLMUL 0
+	#endif
+#endif
+
+// If the compile-time target lacks SSE4.2, the hardware CRC32C path is built for SSE4.2 and PCLMUL
+// regardless and selected at runtime.
+//
+#if XSTD_HW_CRC32C && AMD64_TARGET && GNU_COMPILER && !defined( __SSE4_2__ )
+	#define XSTD_HW_CRC32C_DYNAMIC 1
+	#define __crc32c_target __attribute__(( target( "sse4.2,pclmul" ) ))
+	#define __crc32c_entry  NO_INLINE __crc32c_target
+#else
+	#define XSTD_HW_CRC32C_DYNAMIC 0
+	#define __crc32c_target
+	#define __crc32c_entry  FORCE_INLINE
+#endif
 
 #if ARM64_TARGET
 	#include <arm_acle.h>
+	#if XSTD_HW_CLMUL
+		#include <arm_neon.h>
+	#endif
+#elif AMD64_TARGET && ( XSTD_HW_CLMUL || XSTD_HW_CRC32C_DYNAMIC ) && !MS_COMPILER
+	#include <wmmintrin.h>
+	#if XSTD_HW_CRC32C_DYNAMIC
+		#include <nmmintrin.h>
+	#endif
 #endif
 
 namespace xstd::impl
 {
+	// Carry-less multiplication of two 32-bit polynomials.
+	//
+	__crc32c_target FORCE_INLINE CONST_FN static uint64_t clmul32( uint32_t a, uint32_t b )
+	{
+#if XSTD_HW_CLMUL && ARM64_TARGET
+		return vgetq_lane_u64( vreinterpretq_u64_p128( vmull_p64( a, b ) ), 0 );
+#elif XSTD_HW_CLMUL || XSTD_HW_CRC32C_DYNAMIC
+		return ( uint64_t ) _mm_cvtsi128_si64( _mm_clmulepi64_si128( _mm_cvtsi32_si128( ( int ) a ), _mm_cvtsi32_si128( ( int ) b ), 0 ) );
+#else
+		uint64_t r = 0;
+		for ( int i = 0; i != 32; i++ )
+			r ^= ( uint64_t( a ) << i ) & ( 0 - uint64_t( ( b >> i ) & 1 ) );
+		return r;
+#endif
+	}
+
+	// Calculates x^n mod P for a reflected 32-bit polynomial.
+	//
+	template<uint32_t rpoly>
+	inline constexpr uint32_t crc32_xpow( size_t n )
+	{
+		uint32_t v = 0x80000000;
+		while ( n-- )
+			v = ( v >> 1 ) ^ ( ( v & 1 ) ? rpoly : 0 );
+		return v;
+	}
+
 #if XSTD_HW_CRC32C
 	template<xstd::Integral T>
-	FORCE_INLINE CONST_FN static uint32_t hw_crc32ci( T value, uint32_t crc )
+	__crc32c_target FORCE_INLINE CONST_FN static uint32_t hw_crc32ci( T value, uint32_t crc )
 	{
 #if ARM64_TARGET
 		if constexpr ( sizeof( T ) == 8 )      return ( uint32_t ) __crc32cd( crc, ( uint64_t ) value );
 		else if constexpr ( sizeof( T ) == 4 ) return ( uint32_t ) __crc32cw( crc, ( uint32_t ) value );
 		else if constexpr ( sizeof( T ) == 2 ) return ( uint32_t ) __crc32ch( crc, ( uint16_t ) value );
 		else if constexpr ( sizeof( T ) == 1 ) return ( uint32_t ) __crc32cb( crc, ( uint8_t ) value );
-#elif MS_COMPILER
+#elif MS_COMPILER || XSTD_HW_CRC32C_DYNAMIC
 		if constexpr ( sizeof( T ) == 8 )      return ( uint32_t ) _mm_crc32_u64( crc, ( uint64_t ) value );
 		else if constexpr ( sizeof( T ) == 4 ) return ( uint32_t ) _mm_crc32_u32( crc, ( uint32_t ) value );
 		else if constexpr ( sizeof( T ) == 2 ) return ( uint32_t ) _mm_crc32_u16( crc, ( uint16_t ) value );
@@ -43,11 +100,68 @@ namespace xstd::impl
 #endif
 		else                                   static_assert( sizeof( T ) == 0, "Invalid integral size." );
 	}
-	FORCE_INLINE PURE_FN static uint32_t hw_crc32ci( const uint8_t* ptr, size_t length, uint32_t crc )
+
+	// Entry point for the integral path, out of line under dynamic dispatch so that callers compiled for the
+	// baseline target can reach it.
+	//
+	template<xstd::Integral T>
+	__crc32c_entry CONST_FN static uint32_t hw_crc32ci_entry( T value, uint32_t crc )
+	{
+		return hw_crc32ci( value, crc );
+	}
+
+	// Advances a CRC32C state over N zero bytes given the constant x^(8N-33) mod P.
+	//
+	__crc32c_target FORCE_INLINE CONST_FN static uint32_t hw_crc32c_shift( uint32_t crc, uint32_t k )
+	{
+		return hw_crc32ci( clmul32( crc, k ), 0u );
+	}
+
+	// Computes the CRC of three adjacent N byte streams in parallel to hide the latency of the CRC
+	// instruction, the partial states are then recombined with carry-less multiplication.
+	//
+	template<size_t N>
+	__crc32c_target FORCE_INLINE PURE_FN static uint32_t hw_crc32ci_x3( const uint8_t* ptr, uint32_t crc )
+	{
+		static constexpr uint32_t k1 = crc32_xpow<0x82F63B78>( 8 * N * 2 - 33 );
+		static constexpr uint32_t k2 = crc32_xpow<0x82F63B78>( 8 * N - 33 );
+
+		uint32_t crc1 = 0, crc2 = 0;
+		for ( size_t i = 0; i != N; i += 8 )
+		{
+			crc =  hw_crc32ci( *( uint64_t* ) ( ptr + i ), crc );
+			crc1 = hw_crc32ci( *( uint64_t* ) ( ptr + N + i ), crc1 );
+			crc2 = hw_crc32ci( *( uint64_t* ) ( ptr + N * 2 + i ), crc2 );
+		}
+		return hw_crc32c_shift( crc, k1 ) ^ hw_crc32c_shift( crc1, k2 ) ^ crc2;
+	}
+	static constexpr size_t hw_crc32c_long_block =  3 * 2048;
+	static constexpr size_t hw_crc32c_short_block = 3 * 128;
+	static_assert( ( hw_crc32c_long_block % hw_crc32c_short_block ) == 0 );
+	__crc32c_target NO_INLINE PURE_FN static uint32_t hw_crc32ci_long( const uint8_t* ptr, size_t length, uint32_t crc )
 	{
+		for ( ; length >= hw_crc32c_long_block; ptr += hw_crc32c_long_block, length -= hw_crc32c_long_block )
+			crc = hw_crc32ci_x3<hw_crc32c_long_block / 3>( ptr, crc );
+		for ( ; length >= hw_crc32c_short_block; ptr += hw_crc32c_short_block, length -= hw_crc32c_short_block )
+			crc = hw_crc32ci_x3<hw_crc32c_short_block / 3>( ptr, crc );
+		return crc;
+	}
+
+	__crc32c_entry PURE_FN static uint32_t hw_crc32ci( const uint8_t* ptr, size_t length, uint32_t crc )
+	{
+		// Interleave large buffers.
+		//
+		if ( length >= hw_crc32c_short_block ) [[unlikely]]
+		{
+			size_t interleaved = length - ( length % hw_crc32c_short_block );
+			crc = hw_crc32ci_long( ptr, interleaved, crc );
+			ptr += interleaved;
+			length -= interleaved;
+		}
+
 		// CRC in 64-byte units using qword CRCs until we're done.
 		//
-		length = xstd::unroll_scaled_n<8, 64>( [ & ]
+		length = xstd::unroll_scaled_n<8, 64>( [ & ] () __crc32c_target
 		{
 			crc = hw_crc32ci( *( uint64_t* ) ptr, crc );
 			ptr += 8;
@@ -63,8 +177,25 @@ namespace xstd::impl
 #else
 	template<xstd::Integral T>
 	static uint32_t hw_crc32ci( T value, uint32_t crc );
+	template<xstd::Integral T>
+	static uint32_t hw_crc32ci_entry( T value, uint32_t crc );
 	static uint32_t hw_crc32ci( const uint8_t* ptr, size_t length, uint32_t crc );
 #endif
+
+	// Whether or not the host can run the hardware CRC32C path, queried once, reads before the dynamic
+	// initialization safely observe the software path.
+	//
+#if XSTD_HW_CRC32C_DYNAMIC
+	inline bool detect_hw_crc32c()
+	{
+		__builtin_cpu_init();
+		return __builtin_cpu_supports( "sse4.2" ) && __builtin_cpu_supports( "pclmul" );
+	}
+	inline const bool hw_crc32c_host = detect_hw_crc32c();
+	FORCE_INLINE inline bool hw_crc32c_supported() { return hw_crc32c_host; }
+#else
+	FORCE_INLINE inline constexpr bool hw_crc32c_supported() { return true; }
+#endif
 };
 
 namespace xstd
@@ -96,6 +227,25 @@ namespace xstd
 			return table;
 		}();
 
+		// Slicing-by-8 tables, entry [k][b] is the state after byte b followed by k zero bytes.
+		//
+		static constexpr bool enable_slicing = std::is_integral_v<U> && std::endian::native == std::endian::little;
+		static constexpr auto slicing_table = [ ] ()
+		{
+			std::array<std::array<U, 256>, 8> tables = {};
+			for ( size_t n = 0; n <= 0xFF; n++ )
+				tables[ 0 ][ n ] = U( ~lookup_table[ n ] );
+			for ( size_t k = 1; k != 8; k++ )
+			{
+				for ( size_t n = 0; n <= 0xFF; n++ )
+				{
+					U prev = tables[ k - 1 ][ n ];
+					tables[ k ][ n ] = U( tables[ 0 ][ prev & U( 0xFF ) ] ^ U( uint64_t( prev ) >> 8 ) );
+				}
+			}
+			return tables;
+		}();
+
 		// Magic constants for 32-bit CRC.
 		//
 		using value_type =   U;
@@ -121,16 +271,30 @@ namespace xstd
 			//
 			if constexpr ( enable_hwcrc )
 			{
-				if ( !std::is_constant_evaluated() )
+				if ( !std::is_constant_evaluated() && impl::hw_crc32c_supported() )
 				{
 					value = ~impl::hw_crc32ci( data, n, ~value );
 					return;
 				}
 			}
 
-			// Otherwise fallback to software mode.
+			// Otherwise fallback to software mode, slicing 8 bytes at a time if possible.
 			//
 			U crc = ~value;
+			if constexpr ( enable_slicing )
+			{
+				if ( !std::is_constant_evaluated() )
+				{
+					for ( ; n >= 8; data += 8, n -= 8 )
+					{
+						uint64_t x = *( const uint64_t* ) data ^ uint64_t( crc );
+						crc = slicing_table[ 7 ][ x & 0xFF ] ^ slicing_table[ 6 ][ ( x >> 8 ) & 0xFF ] ^
+						      slicing_table[ 5 ][ ( x >> 16 ) & 0xFF ] ^ slicing_table[ 4 ][ ( x >> 24 ) & 0xFF ] ^
+						      slicing_table[ 3 ][ ( x >> 32 ) & 0xFF ] ^ slicing_table[ 2 ][ ( x >> 40 ) & 0xFF ] ^
+						      slicing_table[ 1 ][ ( x >> 48 ) & 0xFF ] ^ slicing_table[ 0 ][ x >> 56 ];
+					}
+				}
+			}
 			while ( n-- )
 				crc = ( ~lookup_table[ U( *data++ ) ^ ( crc & U( 0xFF ) ) ] ) ^ ( crc >> U( 8 ) );
 			value = ~crc;
@@ -155,8 +319,11 @@ namespace xstd
 				//
 				if constexpr ( Integral<T> && enable_hwcrc )
 				{
-					value = ~impl::hw_crc32ci( data, ~value );
-					return;
+					if ( impl::hw_crc32c_supported() )
+					{
+						value = ~impl::hw_crc32ci_entry( data, ~value );
+						return;
+					}
 				}
 
 				add_bytes( ( const uint8_t* ) &data, sizeof( T ) );
@@ -42,6 +42,99 @@ namespace xstd {
 		static event_primitive& from_handle( handle_type& evt ) { return *(event_primitive*) &evt; }
 	};
 };
+#elif defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+namespace xstd {
+	struct event_primitive {
+		using handle_type = event_primitive*;
+
+		// Futex word, bit 0 is the signal state, bits [1, 16) count the waiters and bits [16, 32) count the notifications observed
+		// by waiters so that a waiter woken by a notify is not put back to sleep by a racing reset. Notify without waiters is a single atomic op.
+		//
+		static constexpr uint32_t signal_bit =  1;
+		static constexpr uint32_t waiter_one =  1 << 1;
+		static constexpr uint32_t waiter_mask = 0x7FFF << 1;
+		static constexpr uint32_t seq_one =     1 << 16;
+		mutable std::atomic<uint32_t> word = 0;
+
+		event_primitive() {}
+		~event_primitive() {}
+
+		inline static long futex( std::atomic<uint32_t>* addr, int op, uint32_t val, const timespec* ts = nullptr ) {
+			return syscall( SYS_futex, (uint32_t*) addr, op, val, ts, nullptr, 0 );
+		}
+
+		// Waits until either the signal bit is set or a notification is observed, returns false on timeout.
+		//
+		inline bool wait_until( const timespec* deadline ) const {
+			uint32_t value = word.load( std::memory_order::acquire );
+			if ( value & signal_bit ) return true;
+
+			value = word.fetch_add( waiter_one, std::memory_order::acquire ) + waiter_one;
+			const uint32_t seq = value & ~( seq_one - 1 );
+			bool result = true;
+			while ( !( value & signal_bit ) && ( value & ~( seq_one - 1 ) ) == seq ) {
+				timespec rel, *ts = nullptr;
+				if ( deadline ) {
+					timespec now;
+					clock_gettime( CLOCK_MONOTONIC, &now );
+					int64_t ns = ( deadline->tv_sec - now.tv_sec ) * 1'000'000'000ll + ( deadline->tv_nsec - now.tv_nsec );
+					if ( ns <= 0 ) {
+						result = false;
+						break;
+					}
+					rel = { time_t( ns / 1'000'000'000 ), long( ns % 1'000'000'000 ) };
+					ts = &rel;
+				}
+				futex( &word, FUTEX_WAIT_PRIVATE, value, ts );
+				value = word.load( std::memory_order::acquire );
+			}
+			word.fetch_sub( waiter_one, std::memory_order::relaxed );
+			return result;
+		}
+		inline void wait() const {
+			wait_until( nullptr );
+		}
+		inline bool wait_for( long long milliseconds ) const {
+			if ( milliseconds <= 0 ) return peek();
+			timespec deadline;
+			clock_gettime( CLOCK_MONOTONIC, &deadline );
+			deadline.tv_sec +=  time_t( milliseconds / 1000 );
+			deadline.tv_nsec += long( milliseconds % 1000 ) * 1'000'000;
+			if ( deadline.tv_nsec >= 1'000'000'000 ) {
+				deadline.tv_sec++;
+				deadline.tv_nsec -= 1'000'000'000;
+			}
+			return wait_until( &deadline );
+		}
+		inline void reset() {
+			if ( word.load( std::memory_order::relaxed ) & signal_bit )
+				word.fetch_and( ~signal_bit, std::memory_order::relaxed );
+		}
+		inline void notify() {
+			uint32_t value = word.load( std::memory_order::relaxed );
+
+			// Set the signal and bump the sequence in a single RMW, the word is not touched after it as a released waiter may
+			// free the event right away; the wake only passes its address to the kernel which tolerates stale futexes.
+			//
+			do {
+				if ( value & signal_bit )
+					return;
+			} while ( !word.compare_exchange_weak( value, ( value | signal_bit ) + seq_one, std::memory_order::release, std::memory_order::relaxed ) );
+			if ( value & waiter_mask )
+				futex( &word, FUTEX_WAKE_PRIVATE, INT_MAX );
+		}
+		inline bool peek() const {
+			return word.load( std::memory_order::acquire ) & signal_bit;
+		}
+		inline handle_type handle() const { return (handle_type) this; }
+		static event_primitive& from_handle( handle_type& evt ) { return *evt; }
+	};
+};
 #else
 #include <mutex>
 #include <condition_variable>
@@ -67,6 +160,7 @@ namespace xstd {
 			return cv.wait_for( lock, time::milliseconds{ milliseconds } ) == std::cv_status::no_timeout;
 		}
 		inline void reset() {
+			std::unique_lock lock{ mtx };
 			state = false;
 		}
 		inline void notify() {
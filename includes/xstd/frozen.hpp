@@ -13,7 +13,7 @@ namespace xstd {
 			FORCE_INLINE inline constexpr size_t operator()( const T& obj, size_t seed ) const noexcept {
 				hash_t h{ seed };
 				extend_hash( h, obj );
-				return h.digest();
+				return h.as64();
 			}
 		};
 	};
@@ -8,6 +8,16 @@
 #include "time.hpp"
 #include "wait_list.hpp"
 #include <vector>
+#include <atomic>
+#include <new>
+#include <cstddef>
+
+// [[Configuration]]
+// XSTD_PROMISE_FRAME_CACHE: If set, promise and coroutine frames are recycled through a per-thread free list.
+//
+#ifndef XSTD_PROMISE_FRAME_CACHE
+	#define XSTD_PROMISE_FRAME_CACHE USER_TARGET
+#endif
 
 namespace xstd
 {
@@ -106,6 +116,98 @@ namespace xstd
 		static constexpr uint8_t  state_written_bit =  1;
 		static constexpr uint16_t state_finished =     1 << state_finished_bit;
 		static constexpr uint16_t state_written =      1 << state_written_bit;
+
+		// Continuation slot details.
+		//  - Slot : [Single awaiter address | Settled | Spilled]
+		//
+		static constexpr uintptr_t slot_spilled = 1; // Wait list might have entries.
+		static constexpr uintptr_t slot_settled = 2; // Promise was signalled, no more entries are accepted.
+		static constexpr uintptr_t slot_flags =   slot_spilled | slot_settled;
+
+		// Per-thread free list of promise frames, blocks are prefixed by their size class.
+		// - Each class caches up to a fixed number of bytes so that fan-outs of small frames recycle fully.
+		// - The header keeps the fundamental alignment, over-aligned frames bypass the cache.
+		//
+		struct frame_cache
+		{
+			static constexpr size_t alignment =    alignof( std::max_align_t );
+			static constexpr size_t header_size =  std::max( alignment, sizeof( size_t ) );
+			static constexpr size_t granularity =  64;
+			static constexpr size_t class_count =  16;
+			static constexpr size_t class_budget = 64 * 1024;
+			static constexpr uint32_t class_depth( size_t cls ) { return uint32_t( class_budget / ( ( cls + 1 ) * granularity ) ); }
+
+			struct free_node { free_node* next; };
+			free_node* lists[ class_count ] = { nullptr };
+			uint32_t   counts[ class_count ] = { 0 };
+
+			static inline thread_local bool closed = false;
+			~frame_cache()
+			{
+				closed = true;
+				for ( auto* it : lists )
+					while ( it )
+						::operator delete( std::exchange( it, it->next ) );
+			}
+		};
+		static inline thread_local frame_cache tls_frame_cache = {};
+		static_assert( ( frame_cache::header_size % frame_cache::alignment ) == 0, "Frame header breaks the alignment." );
+
+		inline void* frame_alloc( size_t n, size_t align = frame_cache::alignment )
+		{
+			if ( align > frame_cache::alignment ) [[unlikely]]
+				return ::operator new( n, std::align_val_t{ align } );
+#if XSTD_PROMISE_FRAME_CACHE
+			size_t cls = ( n + frame_cache::header_size - 1 ) / frame_cache::granularity;
+			void* blk = nullptr;
+			if ( cls < frame_cache::class_count && !frame_cache::closed ) [[likely]]
+			{
+				auto& cache = tls_frame_cache;
+				if ( auto* node = cache.lists[ cls ] )
+				{
+					cache.lists[ cls ] = node->next;
+					cache.counts[ cls ]--;
+					blk = node;
+				}
+				else
+				{
+					blk = ::operator new( ( cls + 1 ) * frame_cache::granularity );
+				}
+			}
+			else
+			{
+				cls = frame_cache::class_count;
+				blk = ::operator new( n + frame_cache::header_size );
+			}
+			*( size_t* ) blk = cls;
+			return ( uint8_t* ) blk + frame_cache::header_size;
+#else
+			return ::operator new( n );
+#endif
+		}
+		inline void frame_free( void* p, size_t align = frame_cache::alignment )
+		{
+			if ( align > frame_cache::alignment ) [[unlikely]]
+				return ::operator delete( p, std::align_val_t{ align } );
+#if XSTD_PROMISE_FRAME_CACHE
+			void* blk = ( uint8_t* ) p - frame_cache::header_size;
+			size_t cls = *( size_t* ) blk;
+			if ( cls < frame_cache::class_count && !frame_cache::closed ) [[likely]]
+			{
+				auto& cache = tls_frame_cache;
+				if ( cache.counts[ cls ] != frame_cache::class_depth( cls ) )
+				{
+					auto* node = ( frame_cache::free_node* ) blk;
+					node->next = std::exchange( cache.lists[ cls ], node );
+					cache.counts[ cls ]++;
+					return;
+				}
+			}
+			::operator delete( blk );
+#else
+			::operator delete( p );
+#endif
+		}
 	};
 
 	// Base of the promise type.
@@ -121,6 +223,10 @@ namespace xstd
 		//
 		impl::atomic_integral<uint16_t>         state = { 0 };
 
+		// Continuation slot for the first awaiter, the wait list is only used past it.
+		//
+		mutable std::atomic<uintptr_t>          slot = 0;
+
 		// Wait list.
 		//
 		mutable wait_list                       waits = {};
@@ -151,40 +257,47 @@ namespace xstd
 		promise_base( std::in_place_t, Promise* promise, uint32_t initial_ref_count = impl::owner_flag )
 			: refs( initial_ref_count ), coro( coroutine_handle<Promise>::from_promise( *promise ) ) {}
 
+		// Marks the wait list as in use, returns false if the promise was already signalled.
+		//
+		bool spill() const {
+			uintptr_t value = slot.load( std::memory_order::relaxed );
+			while ( !( value & impl::slot_spilled ) ) {
+				if ( value & impl::slot_settled )
+					return false;
+				if ( slot.compare_exchange_weak( value, value | impl::slot_spilled, std::memory_order::acq_rel, std::memory_order::relaxed ) )
+					break;
+			}
+			return true;
+		}
+
 		// Waits for the event to be complete.
 		//
 		event_handle event() const {
-			if ( finished() )
+			if ( finished() || !spill() )
 				return nullptr;
 			if ( auto evt = waits.listen() )
 				return evt->handle();
 			return nullptr;
 		}
 		const basic_result<T, S>& wait() const {
-			if ( finished() )
-				return unrace();
-			waits.wait();
-			return result;
+			if ( !finished() && spill() )
+				waits.wait();
+			return unrace();
 		}
 		basic_result<T, S> wait_move() {
-			if ( finished() )
-				return std::move( *( unrace(), &result ) );
-			waits.wait();
-			return std::move( result );
+			if ( !finished() && spill() )
+				waits.wait();
+			return std::move( *( unrace(), &result ) );
 		}
 		const basic_result<T, S>& wait_for( duration time ) const {
-			if ( finished() )
+			if ( finished() || !spill() || waits.wait_for( time ) )
 				return unrace();
-			if ( waits.wait_for( time ) )
-				return result;
 			else
 				return impl::timeout_result<T, S>();
 		}
 		basic_result<T, S> wait_for_move( duration time ) const {
-			if ( finished() )
+			if ( finished() || !spill() || waits.wait_for( time ) )
 				return std::move( *( unrace(), &result ) );
-			if ( waits.wait_for( time ) )
-				return std::move( result );
 			else
 				return impl::timeout_result<T, S>();
 		}
@@ -194,18 +307,55 @@ namespace xstd
 		bool listen( coroutine_handle<> h ) const {
 			if ( finished() ) [[likely]]
 				return ( unrace(), false );
-			return waits.listen( h ) >= 0;
+
+			// Try to take the single awaiter slot.
+			//
+			dassert( !( uintptr_t( h.address() ) & impl::slot_flags ) );
+			uintptr_t expected = 0;
+			if ( slot.compare_exchange_strong( expected, uintptr_t( h.address() ), std::memory_order::acq_rel, std::memory_order::relaxed ) ) [[likely]]
+				return true;
+
+			// Fallback to the wait list.
+			//
+			if ( ( expected & impl::slot_settled ) || !spill() || waits.listen( h ) < 0 )
+				return ( unrace(), false );
+			return true;
 		}
 		bool unlisten( coroutine_handle<> h ) const {
 			if ( finished() ) [[likely]]
 				return ( unrace(), false );
-			return waits.unlisten( h ) >= 0;
+
+			uintptr_t value = slot.load( std::memory_order::relaxed );
+			while ( ( value & ~impl::slot_flags ) == uintptr_t( h.address() ) ) {
+				if ( slot.compare_exchange_weak( value, value & impl::slot_flags, std::memory_order::acq_rel, std::memory_order::relaxed ) )
+					return true;
+			}
+			return ( value & impl::slot_spilled ) && waits.unlisten( h );
 		}
 
 		// Signals the event, runs all continuation entries.
 		//
-		[[nodiscard]] coroutine_handle<> signal() { return waits.signal(); }
-		void signal_async() { waits.signal_async(); }
+		[[nodiscard]] coroutine_handle<> signal() {
+			uintptr_t value = slot.exchange( impl::slot_settled, std::memory_order::acq_rel );
+			auto single = coroutine_handle<>::from_address( ( void* ) ( value & ~impl::slot_flags ) );
+			if ( value & impl::slot_spilled ) {
+				if ( !single )
+					return waits.signal();
+				waits.signal_async();
+			}
+			if ( !single )
+				return noop_coroutine();
+			if ( get_task_priority() > 0 ) [[unlikely]]
+				return ( chore( single ), noop_coroutine() );
+			return single;
+		}
+		void signal_async() {
+			uintptr_t value = slot.exchange( impl::slot_settled, std::memory_order::acq_rel );
+			if ( value & impl::slot_spilled )
+				waits.signal_async();
+			if ( auto single = value & ~impl::slot_flags )
+				chore( coroutine_handle<>::from_address( ( void* ) single ) );
+		}
 
 		// Resolution of the promise value.
 		//
@@ -344,8 +494,9 @@ namespace xstd
 		void destroy()
 		{
 			void* base = coro ? coro.address() : this;
+			size_t align = coro ? impl::frame_cache::alignment : alignof( promise_base );
 			std::destroy_at( this );
-			operator delete( base );
+			impl::frame_free( base, align );
 		}
 		FORCE_INLINE void inc_ref( bool owner )
 		{
@@ -619,7 +770,7 @@ namespace xstd
 	template<typename T = void, typename S = xstd::exception>
 	inline promise<T, S> make_promise()
 	{
-		return promise<T, S>{ std::in_place_t{}, new promise_base<T, S>() };
+		return promise<T, S>{ std::in_place_t{}, new ( impl::frame_alloc( sizeof( promise_base<T, S> ), alignof( promise_base<T, S> ) ) ) promise_base<T, S>() };
 	}
 	template<typename T = void, typename S = xstd::exception>
 	inline promise<T, S> make_rejected_promise( S&& status )
@@ -683,7 +834,7 @@ namespace xstd
 
 			// No delete, promise_base will do that.
 			//
-			void* operator new( size_t n ) { return ::operator new( n ); }
+			void* operator new( size_t n ) { return impl::frame_alloc( n ); }
 			void operator delete( void* ) {}
 
 			future<T, S> get_return_object() { return { std::in_place_t{}, &pr }; }
@@ -738,7 +889,7 @@ namespace xstd
 
 			// No delete, promise_base will do that.
 			//
-			void* operator new( size_t n ) { return ::operator new( n ); }
+			void* operator new( size_t n ) { return impl::frame_alloc( n ); }
 			void operator delete( void* ) {}
 
 			future<void, S> get_return_object() { return { std::in_place_t{}, &pr }; }
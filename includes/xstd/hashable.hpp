@@ -7,10 +7,11 @@
 #include "formatting.hpp"
 #include "fnv.hpp"
 #include "crc.hpp"
+#include "xxhash.hpp"
 #include "ref_counted.hpp"
 
 // [[Configuration]]
-// XSTD_DEFAULT_HASHER: If set, changes the type of default hash_t.
+// XSTD_DEFAULT_HASHER: If set, changes the type of default hash_t, e.g. xstd::xxh3_64.
 //
 #ifndef XSTD_DEFAULT_HASHER
 	#define XSTD_DEFAULT_HASHER xstd::xcrc
@@ -59,6 +60,26 @@ namespace xstd
 			out.add_bytes( in.digest() );
 	}
 
+	// Element types whose hash is exactly their object representation, and whose contiguous ranges
+	// can thus be hashed as a single byte span without changing the digest.
+	//
+	namespace impl
+	{
+		// Types with a dedicated basic_hasher below, or that are hashed per element, never hash as their bytes.
+		//
+		template<typename T>
+		concept DedicatedHashable =
+			Optional<T> || Variant<T> || Tuple<T> || CString<T> || Same<T, std::monostate> ||
+			is_specialization_v<std::reference_wrapper, T> || is_specialization_v<ref, T> ||
+			is_specialization_v<std::shared_ptr, T> || is_specialization_v<std::weak_ptr, T> || is_specialization_v<std::unique_ptr, T>;
+
+		template<typename H, typename T>
+		concept RawHashable = TriviallyCopyable<T> && !Iterable<const T&> && !Tiable<T> && !DedicatedHashable<T> &&
+			!CustomHashable<T> && !CustomHashExtendable<T, H> && !Same<T, H> && !Same<T, hash_t>;
+		template<typename H, typename T>
+		concept BulkHashable = RawHashable<H, T> && ( UniquelyRepresented<T> || FloatingPoint<T> );
+	};
+
 	// Define basic hasher.
 	//
 	template<typename H, typename T>
@@ -77,7 +98,7 @@ namespace xstd
 			else if constexpr ( Iterable<const T&> )
 			{
 				using value_type = std::decay_t<iterable_val_t<const T&>>;
-				if constexpr ( Trivial<value_type> )
+				if constexpr ( impl::RawHashable<H, value_type> )
 				{
 					for ( const auto& entry : value )
 						out.add_bytes( entry );
@@ -317,12 +338,12 @@ namespace xstd
 		}
 	};
 
-	// Overload for contigious trivial iterables.
+	// Overload for contigious iterables of padding-free trivially copyable types, hashes the whole span at once.
 	//
-	template<typename H, ContiguousIterable T> requires Trivial<iterable_val_t<T>>
+	template<typename H, ContiguousIterable T> requires impl::BulkHashable<H, std::decay_t<iterable_val_t<T>>>
 	struct basic_hasher<H, T>
 	{
-		using U = iterable_val_t<T>;
+		using U = std::decay_t<iterable_val_t<T>>;
 
 		FORCE_INLINE constexpr static void extend( H& out, const T& value ) noexcept
 		{
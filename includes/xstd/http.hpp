@@ -4,6 +4,8 @@
 #include <optional>
 #include <string_view>
 #include <unordered_map>
+#include <deque>
+#include <functional>
 #include "spinlock.hpp"
 #include "text.hpp"
 #include "assert.hpp"
@@ -12,6 +14,8 @@
 #include "robin_hood.hpp"
 #include "socket.hpp"
 #include "job.hpp"
+#include "future.hpp"
+#include "finally.hpp"
 
 namespace xstd::http {
 	// Byte utils.
@@ -82,6 +86,39 @@ namespace xstd::http {
 			}
 			return ( mismatch & 0xDFDFDFDF ) == 0;
 		}
+
+		// Case-insensitive hash compatible with fast_ieq, only mixes the length and the first/last 8 bytes so equality must still be checked.
+		//
+		static constexpr uint64_t load_partial( const char* data, size_t count ) {
+			uint64_t result = 0;
+			if ( std::is_constant_evaluated() ) {
+				for ( size_t i = 0; i != count; i++ )
+					result |= uint64_t( uint8_t( data[ i ] ) ) << ( 8 * i );
+			} else {
+				memcpy( &result, data, count );
+			}
+			return result;
+		}
+		static constexpr uint32_t fast_ihash( std::string_view input ) {
+			size_t   count = input.size();
+			uint64_t lo, hi;
+			if ( count >= 8 ) {
+				lo = load_partial( input.data(), 8 );
+				hi = load_partial( input.data() + count - 8, 8 );
+			} else if ( count >= 4 ) {
+				lo = load_partial( input.data(), 4 );
+				hi = load_partial( input.data() + count - 4, 4 );
+			} else {
+				lo = load_partial( input.data(), count );
+				hi = 0;
+			}
+			lo = ( lo & 0xDFDFDFDFDFDFDFDF ) * 0x9E3779B97F4A7C15;
+			hi = ( hi & 0xDFDFDFDFDFDFDFDF ) * 0xC2B2AE3D27D4EB4F;
+			uint64_t h = lo ^ std::rotl( hi, 31 ) ^ count;
+			h ^= h >> 29;
+			h *= 0xBF58476D1CE4E5B9;
+			return uint32_t( h ^ ( h >> 32 ) );
+		}
 	};
 
 	// Reads a single HTTP line terminated with \r\n, skips the content in the buffer, returns the line itself as a string view.
@@ -104,6 +141,185 @@ namespace xstd::http {
 		} );
 	}
 
+	// Vectorized line feed search used by the head parser.
+	//
+	namespace detail {
+		static size_t find_lf( const char* data, size_t pos, size_t length ) {
+			constexpr size_t width = std::min<size_t>( XSTD_SIMD_WIDTH, 32 );
+			for ( ; ( pos + width ) <= length; pos += width ) {
+				if ( uint32_t mask = ( xvec<char, width>::load( data + pos ) == '\n' ).bmask() )
+					return pos + lsb( mask );
+			}
+			for ( ; pos != length; pos++ ) {
+				if ( data[ pos ] == '\n' )
+					return pos;
+			}
+			return std::string_view::npos;
+		}
+	};
+
+	// Incremental HTTP/1.1 head parser, tokenizes the start line and the header fields in-place and remembers where it
+	// stopped so that a head trickling in over many segments is scanned only once. Tokens are stored as offsets since
+	// the buffer may be reallocated in between calls.
+	//
+	struct head_parser {
+		enum state_t : uint8_t {
+			incomplete,
+			complete,
+			invalid,
+			too_large,
+		};
+		struct token {
+			uint32_t offset = 0;
+			uint32_t length = 0;
+
+			std::string_view view( std::span<const uint8_t> data ) const {
+				return { (const char*) data.data() + offset, length };
+			}
+		};
+		struct field {
+			token name;
+			token value;
+		};
+
+		// Options.
+		//
+		bool               is_response = false;
+		size_t             limit =       std::dynamic_extent;
+
+		// Start line, method/target for requests and status/reason for responses.
+		//
+		token              method =  {};
+		token              target =  {};
+		token              version = {};
+		token              reason =  {};
+		int                status =  -1;
+
+		// Header fields in the order of appearance.
+		//
+		std::vector<field> fields = {};
+
+		// Scanner state, length is set to the size of the head once complete.
+		//
+		state_t            state =      incomplete;
+		bool               started =    false;
+		size_t             scan_pos =   0;
+		size_t             line_pos =   0;
+		size_t             length =     0;
+
+		head_parser( bool is_response = false, size_t limit = std::dynamic_extent ) : is_response( is_response ), limit( limit ) {}
+
+		// Resets the state, keeps the options and the field storage.
+		//
+		void reset() {
+			method = target = version = reason = {};
+			status = -1;
+			fields.clear();
+			state = incomplete;
+			started = false;
+			scan_pos = line_pos = length = 0;
+		}
+
+		// Continues parsing given the entire buffer, which must start with the head and only grow between calls.
+		//
+		state_t feed( std::span<const uint8_t> data ) {
+			if ( state != incomplete )
+				return state;
+
+			const char* base = (const char*) data.data();
+			while ( true ) {
+				size_t lf = detail::find_lf( base, scan_pos, data.size() );
+				if ( lf == std::string_view::npos ) {
+					scan_pos = data.size();
+					if ( data.size() > limit )
+						return state = too_large;
+					return incomplete;
+				}
+				if ( lf >= limit )
+					return state = too_large;
+
+				size_t end = ( lf != line_pos && base[ lf - 1 ] == '\r' ) ? lf - 1 : lf;
+				size_t next = lf + 1;
+				if ( !started ) {
+					// Servers should ignore empty lines preceding the request line.
+					//
+					if ( end != line_pos || is_response ) {
+						if ( !( is_response ? parse_status_line( base, end ) : parse_request_line( base, end ) ) )
+							return state = invalid;
+						started = true;
+					}
+				} else if ( end == line_pos ) {
+					length = next;
+					return state = complete;
+				} else if ( !parse_field( base, end ) ) {
+					return state = invalid;
+				}
+				line_pos = scan_pos = next;
+			}
+		}
+
+	private:
+		token make_token( size_t begin, size_t end ) const {
+			return { uint32_t( begin ), uint32_t( end - begin ) };
+		}
+
+		// Tokenizes "METHOD SP target SP version".
+		//
+		bool parse_request_line( const char* base, size_t end ) {
+			std::string_view line{ base + line_pos, end - line_pos };
+			size_t sp1 = line.find( ' ' );
+			if ( sp1 == std::string_view::npos || !sp1 )
+				return false;
+			size_t sp2 = line.find( ' ', sp1 + 1 );
+			if ( sp2 == std::string_view::npos || sp2 == ( sp1 + 1 ) )
+				return false;
+			method =  make_token( line_pos, line_pos + sp1 );
+			target =  make_token( line_pos + sp1 + 1, line_pos + sp2 );
+			version = make_token( line_pos + sp2 + 1, end );
+			return true;
+		}
+
+		// Tokenizes "version SP 3DIGIT [SP reason]".
+		//
+		bool parse_status_line( const char* base, size_t end ) {
+			std::string_view line{ base + line_pos, end - line_pos };
+			size_t sp = line.find( ' ' );
+			if ( sp == std::string_view::npos || ( line.size() - sp ) < 4 )
+				return false;
+			version = make_token( line_pos, line_pos + sp );
+
+			status = 0;
+			for ( size_t i = sp + 1; i != ( sp + 4 ); i++ ) {
+				if ( line[ i ] < '0' || line[ i ] > '9' )
+					return false;
+				status = status * 10 + ( line[ i ] - '0' );
+			}
+			if ( line.size() == ( sp + 4 ) ) {
+				reason = make_token( end, end );
+			} else if ( line[ sp + 4 ] == ' ' ) {
+				reason = make_token( line_pos + sp + 5, end );
+			} else {
+				return false;
+			}
+			return true;
+		}
+
+		// Tokenizes "name: OWS value OWS", rejects whitespace before the colon and obsolete line folding.
+		//
+		bool parse_field( const char* base, size_t end ) {
+			const char* line = base + line_pos;
+			const char* colon = (const char*) memchr( line, ':', end - line_pos );
+			if ( !colon || colon == line || line[ 0 ] == ' ' || line[ 0 ] == '\t' || colon[ -1 ] == ' ' || colon[ -1 ] == '\t' )
+				return false;
+
+			size_t vbegin = ( colon - base ) + 1, vend = end;
+			while ( vbegin != vend && ( base[ vbegin ] == ' ' || base[ vbegin ] == '\t' ) ) vbegin++;
+			while ( vend != vbegin && ( base[ vend - 1 ] == ' ' || base[ vend - 1 ] == '\t' ) ) vend--;
+			fields.push_back( { make_token( line_pos, colon - base ), make_token( vbegin, vend ) } );
+			return true;
+		}
+	};
+
 	// HTTP status.
 	//
 	namespace detail {
@@ -297,15 +513,25 @@ namespace xstd::http {
 		{ "Cookie", "; " },
 		// For all other headers, the values are joined together with `, `.
 	};
-	static constexpr std::string_view get_header_join_seperator( std::string_view e ) {
-		for ( auto& [k, v] : header_join_keys ) {
-			if ( detail::fast_ieq( k, e ) )
-				return v;
+	static constexpr auto header_join_hashes = [ ] {
+		std::array<uint32_t, std::size( header_join_keys )> result = {};
+		for ( size_t i = 0; i != result.size(); i++ )
+			result[ i ] = detail::fast_ihash( header_join_keys[ i ].first );
+		return result;
+	}();
+	static constexpr std::string_view get_header_join_seperator( std::string_view e, uint32_t hash ) {
+		for ( size_t i = 0; i != header_join_hashes.size(); i++ ) {
+			if ( header_join_hashes[ i ] == hash && detail::fast_ieq( header_join_keys[ i ].first, e ) )
+				return header_join_keys[ i ].second;
 		}
 		return ", "sv;
 	}
+	static constexpr std::string_view get_header_join_seperator( std::string_view e ) {
+		return get_header_join_seperator( e, detail::fast_ihash( e ) );
+	}
 
 	// HTTP headers structure.
+	// - Lines are stored contiguously in a single buffer in insertion order, indexed by an open-addressed table of case-insensitive key hashes.
 	//
 	using  headers_init = std::initializer_list<std::pair<std::string_view, std::string_view>>;
 	struct headers {
@@ -315,77 +541,75 @@ namespace xstd::http {
 			merge_overwrite,
 			merge_overwrite_if,
 		};
+
+		// View of a single header line.
+		//
 		struct header_entry {
-			size_t     k_len =  0;
-			vec_buffer line = {};
-			header_entry( std::string_view key, std::string_view value ) : k_len( key.size() ) {
-				detail::append_into( line, key, ": ", value, "\r\n" );
-			}
+			std::string_view line = {};
+			size_t           k_len = 0;
 
 			// String conversion.
 			//
 			std::string to_string() const {
-				return std::string{ write().substr( 0, line.size() - 2 ) };
+				return std::string{ line.substr( 0, line.size() - 2 ) };
 			}
 
 			// Returns a view of the raw header line.
 			//
 			std::string_view write() const {
-				return std::string_view{ (char*) line.data(), line.size() };
+				return line;
 			}
 			
 			// Key, value.
 			//
 			std::string_view key() const {
-				return write().substr(0, k_len);
+				return line.substr( 0, k_len );
 			}
 			std::string_view value() const {
-				auto result = write().substr(k_len + 2);
+				auto result = line.substr( k_len + 2 );
 				return result.substr( 0, result.size() - 2 );
 			}
+		};
 
-			// Replaces the value.
-			//
-			void assign( std::string_view value ) {
-				line.resize( k_len + 2 );
-				detail::append_into( line, value, "\r\n" );
-			}
-
-			// Inserts another value into the inline-array.
-			//
-			bool merge( std::string_view value, merge_kind kind ) {
-				if ( kind == merge_discard ) {
-					return true;
-				} else if ( kind == merge_overwrite ) {
-					assign( value );
-					return true;
-				}
+		// Location of a line within the buffer.
+		//
+		struct line_ref {
+			uint32_t offset = 0;
+			uint32_t length = 0;
+			uint32_t k_len =  0;
+			uint32_t hash =   0;
+		};
 
-				auto sep = get_header_join_seperator( key() );
-				if ( sep == "\0"sv ) {
-					return false;
-				}
-				if ( sep.empty() ) {
-					// discard if gets discarded
-					if ( kind == merge_overwrite_if ) {
-						assign( value );
-					}
-				} else {
-					detail::insert_into( line, line.size() - 2, sep, value );
-				}
-				return true;
-			}
+		// Iterator yielding header entries in insertion order.
+		//
+		struct const_iterator {
+			const line_ref* it =   nullptr;
+			const uint8_t*  base = nullptr;
+
+			using iterator_category = std::forward_iterator_tag;
+			using difference_type =   ptrdiff_t;
+			using value_type =        header_entry;
+			using reference =         header_entry;
+			using pointer =           void;
+
+			header_entry operator*() const { return { { (const char*) base + it->offset, it->length }, it->k_len }; }
+			const_iterator& operator++() { ++it; return *this; }
+			const_iterator operator++( int ) { auto s = *this; ++it; return s; }
+			bool operator==( const const_iterator& o ) const { return it == o.it; }
 		};
-		using iterator =       typename std::vector<header_entry>::iterator;
-		using const_iterator = typename std::vector<header_entry>::const_iterator;
+		using iterator = const_iterator;
 		
-		// Underlying storage.
+		// Underlying storage, garbage is the number of bytes in the buffer no longer referenced by any line.
 		//
-		std::vector<header_entry> storage = {};
-		iterator begin() { return storage.begin(); }
-		const_iterator begin() const { return storage.begin(); }
-		iterator end() { return storage.end(); }
-		const_iterator end() const { return storage.end(); }
+		vec_buffer            data =    {};
+		std::vector<line_ref> lines =   {};
+		std::vector<uint32_t> index =   {};
+		size_t                garbage = 0;
+
+		const_iterator begin() const { return { lines.data(), data.data() }; }
+		const_iterator end() const { return { lines.data() + lines.size(), data.data() }; }
+		size_t size() const { return lines.size(); }
+		bool empty() const { return lines.empty(); }
 
 		// Default construction/move/copy.
 		//
@@ -401,54 +625,198 @@ namespace xstd::http {
 			append_range( entries, overwrite );
 		}
 
-		// Searcher.
+		// Reserves space for the given number of lines and bytes.
 		//
-		std::pair<iterator, bool> search( std::string_view key ) {
-			auto beg = std::lower_bound( begin(), end(), key.size(), []( const header_entry& a, size_t b ) { return a.k_len < b; } );
-			for ( auto it = beg; it != storage.end(); ++it ) {
-				if ( it->k_len != key.size() ) break;
-				if ( detail::fast_ieq( it->key(), key ) ) return { it, true };
+		void reserve( size_t count, size_t bytes ) {
+			lines.reserve( count );
+			data.reserve( bytes );
+			if ( index.size() < ( count * 2 ) )
+				rehash( count * 2 );
+		}
+		void clear() {
+			data.clear();
+			lines.clear();
+			index.clear();
+			garbage = 0;
+		}
+
+		// Index helpers.
+		//
+		static uint32_t hash_key( std::string_view key ) {
+			return detail::fast_ihash( key );
+		}
+		header_entry at( size_t n ) const {
+			return *const_iterator{ &lines[ n ], data.data() };
+		}
+		bool matches( const line_ref& ref, std::string_view key, uint32_t hash ) const {
+			return ref.hash == hash && ref.k_len == key.size() && detail::fast_ieq( { (const char*) data.data() + ref.offset, ref.k_len }, key );
+		}
+		void rehash( size_t capacity ) {
+			capacity = std::max<size_t>( std::bit_ceil( capacity ), 16 );
+			index.assign( capacity, 0 );
+			for ( size_t n = 0; n != lines.size(); n++ )
+				index_insert( n );
+		}
+		void index_insert( size_t n ) {
+			size_t mask = index.size() - 1;
+			for ( size_t i = lines[ n ].hash & mask;; i = ( i + 1 ) & mask ) {
+				if ( !index[ i ] ) {
+					index[ i ] = uint32_t( n + 1 );
+					return;
+				}
 			}
-			return { beg, false };
 		}
-		std::pair<const_iterator, bool> search( std::string_view key ) const {
-			return const_cast<headers*>( this )->search( key );
+		template<typename F>
+		void index_enum( std::string_view key, uint32_t hash, F&& fn ) const {
+			if ( index.empty() ) return;
+			size_t mask = index.size() - 1;
+			for ( size_t i = hash & mask; index[ i ]; i = ( i + 1 ) & mask ) {
+				size_t n = index[ i ] - 1;
+				if ( matches( lines[ n ], key, hash ) && fn( n ) )
+					return;
+			}
+		}
+
+		// Searcher, returns the index of the first line with the key or npos.
+		// - Lines are always indexed in order so the first match in the probe sequence is the earliest one.
+		//
+		size_t search( std::string_view key, uint32_t hash ) const {
+			size_t result = std::string::npos;
+			index_enum( key, hash, [ & ]( size_t n ) {
+				result = n;
+				return true;
+			} );
+			return result;
+		}
+		size_t search( std::string_view key ) const {
+			return search( key, hash_key( key ) );
+		}
+
+		// Buffer helpers.
+		//
+		void emit_line( line_ref& ref, std::string_view key, std::string_view value, std::string_view prefix = {} ) {
+			ref.offset = uint32_t( data.size() );
+			detail::append_into( data, key, ": ", prefix, value, "\r\n" );
+			ref.length = uint32_t( data.size() - ref.offset );
+			ref.k_len =  uint32_t( key.size() );
+		}
+		void replace_line( size_t n, std::string_view value, std::string_view sep = {} ) {
+			line_ref& ref = lines[ n ];
+			header_entry prev = at( n );
+
+			// If the line is at the end of the buffer, rewrite in place.
+			//
+			if ( ( ref.offset + ref.length ) == data.size() ) {
+				if ( sep.empty() ) {
+					data.shrink_resize( ref.offset + ref.k_len + 2 );
+					detail::append_into( data, value, "\r\n" );
+				} else {
+					data.shrink_resize( ref.offset + ref.length - 2 );
+					detail::append_into( data, sep, value, "\r\n" );
+				}
+				ref.length = uint32_t( data.size() - ref.offset );
+				return;
+			}
+
+			// Otherwise relocate the line to the end, copying the previous value out since the buffer may be reallocated.
+			//
+			std::string key{ prev.key() };
+			std::string old_value{ sep.empty() ? std::string_view{} : prev.value() };
+			garbage += ref.length;
+			if ( sep.empty() ) {
+				emit_line( ref, key, value );
+			} else {
+				ref.offset = uint32_t( data.size() );
+				detail::append_into( data, key, ": ", old_value, sep, value, "\r\n" );
+				ref.length = uint32_t( data.size() - ref.offset );
+			}
+			if ( garbage > ( data.size() / 2 ) )
+				compact();
 		}
-		template<typename It>
-		It search_upper( It it ) const {
-			It prev = it;
-			while ( it != end() && it->k_len == prev->k_len && detail::fast_ieq( it->key(), prev->key() ) ) {
-				++it;
+		void compact() {
+			vec_buffer result = {};
+			result.reserve( data.size() - garbage );
+			for ( auto& ref : lines ) {
+				uint32_t offset = uint32_t( result.size() );
+				result.append_range( data.subspan( ref.offset, ref.length ) );
+				ref.offset = offset;
 			}
-			return it;
+			data = std::move( result );
+			garbage = 0;
 		}
 
 		// Mutators.
 		//
-		header_entry& try_emplace( std::string_view key, std::string_view value, merge_kind directive = merge_overwrite ) {
-			auto [it, found] = search( key );
-			if ( found ) {
-				if ( it->merge( value, directive ) )
-					return *it;
-				it = search_upper( it );
+		header_entry try_emplace( std::string_view key, std::string_view value, merge_kind directive = merge_overwrite ) {
+			// Arguments referencing our own buffer may be invalidated by the write, copy them first.
+			//
+			auto aliases = [ & ]( std::string_view v ) {
+				return !v.empty() && (const uint8_t*) v.data() >= data.data() && (const uint8_t*) v.data() < ( data.data() + data.size() );
+			};
+			if ( aliases( key ) || aliases( value ) ) [[unlikely]] {
+				std::string k{ key }, v{ value };
+				return try_emplace( k, v, directive );
 			}
-			return *storage.insert( it, header_entry{ key, value } );
-		}
-		header_entry& try_insert( std::string_view key, std::string_view value ) {
+
+			uint32_t hash = hash_key( key );
+			if ( size_t n = search( key, hash ); n != std::string::npos ) {
+				if ( directive == merge_discard ) {
+					return at( n );
+				} else if ( directive == merge_overwrite ) {
+					replace_line( n, value );
+					return at( n );
+				}
+
+				auto sep = get_header_join_seperator( key, hash );
+				if ( sep != "\0"sv ) {
+					if ( sep.empty() ) {
+						// discard if gets discarded
+						if ( directive == merge_overwrite_if )
+							replace_line( n, value );
+					} else {
+						replace_line( n, value, sep );
+					}
+					return at( n );
+				}
+			}
+
+			// Append a new line, reserving for a typical message on first insertion.
+			//
+			if ( lines.empty() && !lines.capacity() )
+				reserve( 32, 1024 );
+			auto& ref = lines.emplace_back();
+			ref.hash = hash;
+			emit_line( ref, key, value );
+			if ( index.size() < ( lines.size() * 2 ) )
+				rehash( lines.size() * 2 );
+			else
+				index_insert( lines.size() - 1 );
+			return at( lines.size() - 1 );
+		}
+		header_entry try_insert( std::string_view key, std::string_view value ) {
 			return try_emplace( key, value, merge_discard );
 		}
-		header_entry& set( std::string_view key, std::string_view value, bool overwrite = true ) {
+		header_entry set( std::string_view key, std::string_view value, bool overwrite = true ) {
 			return try_emplace( key, value, overwrite ? merge_overwrite_if : merge_discard_if );
 		}
 		size_t remove( std::string_view key ) {
-			auto [it, found] = search( key );
-			if ( found ) {
-				auto end = search_upper( it );
-				size_t n = end - it;
-				storage.erase( it, end );
-				return n;
+			uint32_t hash = hash_key( key );
+			size_t n = std::erase_if( lines, [ & ]( const line_ref& ref ) {
+				if ( !matches( ref, key, hash ) )
+					return false;
+				garbage += ref.length;
+				return true;
+			} );
+			if ( n ) {
+				if ( lines.empty() ) {
+					clear();
+				} else {
+					if ( garbage > ( data.size() / 2 ) )
+						compact();
+					rehash( lines.size() * 2 );
+				}
 			}
-			return 0;
+			return n;
 		}
 		template<typename T>
 		void append_range( T&& range, bool overwrite = true ) {
@@ -456,15 +824,61 @@ namespace xstd::http {
 				set( k, v, overwrite );
 			}
 		}
+		void append_fields( const head_parser& parser, std::span<const uint8_t> data ) {
+			reserve( lines.size() + parser.fields.size(), this->data.size() + parser.length );
+			for ( auto& field : parser.fields ) {
+				set( field.name.view( data ), field.value.view( data ), false );
+			}
+		}
+
+		// Takes over the buffer holding a parsed head as the storage, the fields are referenced in place so the values
+		// are views into the received bytes. If a field is not in the "key: value\r\n" form or has to be merged with a
+		// previous one, falls back to appending them one by one.
+		//
+		void adopt_fields( const head_parser& parser, vec_buffer&& head ) {
+			if ( !empty() ) {
+				append_fields( parser, head.subspan() );
+				return;
+			}
+			clear();
+			data = std::move( head );
+			lines.reserve( parser.fields.size() );
+			rehash( parser.fields.size() * 2 );
+
+			size_t referenced = 0;
+			for ( auto& field : parser.fields ) {
+				std::string_view key = field.name.view( data.subspan() );
+				uint32_t hash = hash_key( key );
+				size_t key_end = field.name.offset + field.name.length;
+				size_t value_end = field.value.offset + field.value.length;
+				bool canonical = field.value.offset == ( key_end + 2 ) && data[ key_end ] == ':' && data[ key_end + 1 ] == ' ' &&
+				                 ( value_end + 2 ) <= data.size() && data[ value_end ] == '\r' && data[ value_end + 1 ] == '\n';
+				if ( !canonical || ( search( key, hash ) != std::string::npos && get_header_join_seperator( key, hash ) != "\0"sv ) ) {
+					vec_buffer owned = std::move( data );
+					clear();
+					append_fields( parser, owned.subspan() );
+					return;
+				}
+
+				auto& ref = lines.emplace_back();
+				ref.offset = field.name.offset;
+				ref.length = uint32_t( value_end + 2 - field.name.offset );
+				ref.k_len =  field.name.length;
+				ref.hash =   hash;
+				index_insert( lines.size() - 1 );
+				referenced += ref.length;
+			}
+			garbage = data.size() - referenced;
+		}
 
 		// Observers.
 		//
 		bool has( std::string_view key ) const {
-			return search( key ).second;
+			return search( key ) != std::string::npos;
 		}
 		std::optional<std::string_view> get_if( std::string_view key ) const {
-			auto [it, found] = search( key );
-			if ( found ) return it->value();
+			if ( size_t n = search( key ); n != std::string::npos )
+				return at( n ).value();
 			return {};
 		}
 		std::string_view get( std::string_view key ) const {
@@ -473,17 +887,29 @@ namespace xstd::http {
 		std::string_view operator[]( std::string_view key ) const {
 			return get( key );
 		}
-		std::span<const header_entry> list( std::string_view key ) {
-			auto [beg, found] = search( key );
-			if ( !found ) return {};
-			return { std::to_address( beg ), std::to_address( search_upper( beg ) ) };
+		std::vector<header_entry> list( std::string_view key ) const {
+			std::vector<size_t> matches;
+			index_enum( key, hash_key( key ), [ & ]( size_t n ) {
+				matches.emplace_back( n );
+				return false;
+			} );
+			std::sort( matches.begin(), matches.end() );
+
+			std::vector<header_entry> result;
+			result.reserve( matches.size() );
+			for ( size_t n : matches )
+				result.emplace_back( at( n ) );
+			return result;
 		}
 
 		// Writers.
 		//
 		void write( vec_buffer& buf ) const {
-			for ( auto& pair : *this ) {
-				buf.append_range( pair.line );
+			if ( !garbage ) {
+				buf.append_range( data );
+			} else {
+				for ( auto& ref : lines )
+					buf.append_range( data.subspan( ref.offset, ref.length ) );
 			}
 		}
 		auto write( stream_view stream ) const {
@@ -492,6 +918,17 @@ namespace xstd::http {
 			} );
 		}
 
+		// Writes every line except the framing headers, used by writers that declare the framing themselves.
+		//
+		void write_unframed( vec_buffer& buf ) const {
+			for ( auto& ref : lines ) {
+				std::string_view key{ (const char*) data.data() + ref.offset, ref.k_len };
+				if ( detail::fast_ieq( key, "Content-Length" ) || detail::fast_ieq( key, "Transfer-Encoding" ) )
+					continue;
+				buf.append_range( data.subspan( ref.offset, ref.length ) );
+			}
+		}
+
 		// Readers.
 		//
 		std::optional<exception> read( vec_buffer& buf ) {
@@ -576,40 +1013,148 @@ namespace xstd::http {
 			}
 		}
 
-		// Readers.
+		// Parses the chunk size line, ignoring any chunk extensions.
 		//
-		static job<bool> read_chunked( vec_buffer& output, stream_view input ) {
-			while ( true ) {
-				// Read the length.
-				//
-				auto line = co_await readln( input );
-				if ( !line ) [[unlikely]] {
-					co_return false;
+		static std::optional<size_t> parse_chunk_size( std::string_view line ) {
+			size_t n = 0, i = 0;
+			for ( ; i != line.size(); i++ ) {
+				char c = line[ i ] | 0x20;
+				if ( '0' <= c && c <= '9' )      c -= '0';
+				else if ( 'a' <= c && c <= 'f' ) c -= 'a' - 0xA;
+				else                             break;
+				if ( i == ( sizeof( size_t ) * 2 - 1 ) ) [[unlikely]]
+					return std::nullopt;
+				n = ( n << 4 ) | size_t( c );
+			}
+			if ( !i ) [[unlikely]]
+				return std::nullopt;
+			for ( ; i != line.size() && ( line[ i ] == ' ' || line[ i ] == '\t' ); i++ );
+			if ( i != line.size() && line[ i ] != ';' ) [[unlikely]]
+				return std::nullopt;
+			return n;
+		}
+
+		// Consumer of a streamed body, returning false aborts the transfer.
+		//
+		using sink = std::function<job<bool>( std::span<const uint8_t> )>;
+
+		// Incremental body reader, yields the body in bounded pieces as it arrives instead of buffering the whole message.
+		//
+		struct reader {
+			stream_view stream =    {};
+			props       prop =      {};
+			size_t      remaining = 0; // Bytes left in the current chunk.
+
+			// State.
+			//
+			bool done() const { return prop.code == finished || prop.code == error; }
+			bool failed() const { return prop.code == error; }
+
+			// Appends at most max bytes of the body to the output, returns the number of bytes read, zero if done or on failure.
+			//
+			job<size_t> read_some( vec_buffer& output, size_t max = 64_kb ) {
+				switch ( prop.code ) {
+					case raw: {
+						size_t n = std::min( prop.length, max );
+						size_t k = co_await stream.read_into( output.push( n ), 1, n );
+						output.pop( n - k );
+						if ( !k ) {
+							bool until_close = prop.length == std::dynamic_extent;
+							prop.code = ( until_close && !stream.errored() ) ? finished : error;
+						} else if ( prop.length != std::dynamic_extent ) {
+							if ( !( prop.length -= k ) )
+								prop.code = finished;
+						}
+						co_return k;
+					}
+					case chunked: {
+						// Read the chunk header if at the boundary, if terminator chunk, skip the trailers.
+						//
+						if ( !remaining ) {
+							auto line = co_await readln( stream );
+							std::optional<size_t> n;
+							if ( line ) n = parse_chunk_size( *line );
+							if ( !n ) [[unlikely]] {
+								if ( line ) stream.stop( XSTD_ESTR( "invalid chunked message" ) );
+								prop.code = error;
+								co_return 0;
+							}
+							if ( !*n ) {
+								while ( true ) {
+									auto trailer = co_await readln( stream );
+									if ( !trailer ) [[unlikely]] {
+										prop.code = error;
+										co_return 0;
+									}
+									if ( trailer->empty() ) break;
+								}
+								prop.code = finished;
+								co_return 0;
+							}
+							remaining = *n;
+						}
+
+						// Read as much of the chunk as requested, consume the footer if complete.
+						//
+						size_t n = std::min( remaining, max );
+						size_t k = co_await stream.read_into( output.push( n ), 1, n );
+						output.pop( n - k );
+						if ( !k ) [[unlikely]] {
+							prop.code = error;
+							co_return 0;
+						}
+						if ( !( remaining -= k ) ) {
+							uint8_t footer[ 2 ];
+							if ( !co_await stream.read_into( footer, 2 ) || memcmp( footer, "\r\n", 2 ) ) [[unlikely]] {
+								stream.stop( XSTD_ESTR( "invalid chunked message" ) );
+								prop.code = error;
+								co_return 0;
+							}
+						}
+						co_return k;
+					}
+					case finished:
+					case error:
+						co_return 0;
+					default:
+						prop.code = error;
+						co_return 0;
 				}
+			}
 
-				// Read the chunk length, if terminator chunk, break.
-				//
-				size_t n = parse_number<size_t>( *line, 16 );
-				if ( !n ) {
-					if ( line->empty() ) {
-						input.stop( XSTD_ESTR( "invalid chunked message" ) );
+			// Returns the next piece of the body, empty if done or on failure.
+			//
+			job<vec_buffer> next( size_t max = 64_kb ) {
+				vec_buffer result = {};
+				while ( !done() && result.empty() )
+					co_await read_some( result, max );
+				co_return result;
+			}
+
+			// Passes the rest of the body to the sink piece by piece, returns false if the body failed or the sink rejected it.
+			//
+			job<bool> pipe( const sink& fn, size_t max = 64_kb ) {
+				vec_buffer piece = {};
+				while ( !done() ) {
+					piece.clear();
+					if ( co_await read_some( piece, max ) && !co_await fn( std::span<const uint8_t>{ piece.data(), piece.size() } ) )
 						co_return false;
-					}
-					co_return !!( co_await readln( input ) );
 				}
+				co_return !failed();
+			}
+		};
 
-				// Read the chunk + the footer.
-				//
-				n += 2;
-				uint8_t* out = output.push( n );
-				co_await input.read_into( out, n );
-				if ( memcmp( out + n - 2, "\r\n", 2 ) ) [[unlikely]] {
-					input.stop( XSTD_ESTR( "invalid chunked message" ) );
+		// Readers.
+		// - If the chunked payload exceeds the limit, returns false leaving the stream open so the caller can reply.
+		//
+		static job<bool> read_chunked( vec_buffer& output, stream_view input, size_t limit = std::dynamic_extent ) {
+			reader rd{ input, { std::dynamic_extent, chunked } };
+			while ( !rd.done() ) {
+				if ( output.size() > limit ) [[unlikely]]
 					co_return false;
-				} else {
-					output.pop( 2 );
-				}
+				co_await rd.read_some( output, std::min<size_t>( limit - output.size(), 1_mb ) + 1 );
 			}
+			co_return !rd.failed() && output.size() <= limit;
 		}
 		static job<bool> read_raw( vec_buffer& output, stream_view input, size_t content_length = std::dynamic_extent ) {
 			if ( content_length ) {
@@ -640,7 +1185,6 @@ namespace xstd::http {
 		}
 
 		// Writer, writes headers as well as it may need to be modified.
-		// - TODO: chunked & streaming.
 		//
 		static void write( vec_buffer& output, std::span<const uint8_t> input, method_id method, int status ) {
 			const bool is_request = status < 100;
@@ -657,6 +1201,47 @@ namespace xstd::http {
 				output.append_range( input );
 			}
 		}
+
+		// Chunked encoders, the head should be terminated with write_head which declares the transfer encoding.
+		//
+		static void write_chunk( vec_buffer& output, std::span<const uint8_t> input ) {
+			if ( input.empty() ) return; // Empty chunk would terminate the body.
+			char buffer[ 32 ];
+			auto header = xstd::fmt::into( buffer, "%llx\r\n", (unsigned long long) input.size() );
+			output.append_range( std::span{ (uint8_t*) header.data(), header.size() } );
+			output.append_range( input );
+			detail::append_into( output, "\r\n" );
+		}
+		static void write_last_chunk( vec_buffer& output ) {
+			detail::append_into( output, "0\r\n\r\n" );
+		}
+		static void write_head( vec_buffer& output, method_id method, int status ) {
+			if ( is_always_empty( method, status ) )
+				detail::append_into( output, "\r\n" );
+			else
+				detail::append_into( output, "Transfer-Encoding: chunked\r\n\r\n" );
+		}
+
+		// Producer-side chunked writer, each write is flushed as a single chunk with backpressure from the stream watermark.
+		//
+		struct chunked_writer {
+			stream_view stream = {};
+
+			auto write( std::span<const uint8_t> data ) {
+				return stream.write_using( [&]( vec_buffer& buf ) {
+					write_chunk( buf, data );
+				} );
+			}
+			auto finish() {
+				return stream.write_using( []( vec_buffer& buf ) {
+					write_last_chunk( buf );
+				} );
+			}
+		};
+
+		// Producer of a streamed body, returning false aborts the transfer.
+		//
+		using source = std::function<job<bool>( chunked_writer& )>;
 	}
 
 	// Base message type.
@@ -674,6 +1259,10 @@ namespace xstd::http {
 		body::props     body_props = { 0, body::unknown };
 		exception       connection_error = {};
 
+		// Optional body producer, if set the message is sent with a chunked body produced by it in place of the buffered one.
+		//
+		body::source    body_source = {};
+
 		// Error state.
 		//
 		bool ok() const {
@@ -717,6 +1306,9 @@ namespace xstd::http {
 		job<bool> read_body( stream_view stream ) {
 			return body::read( body, stream, body_props );
 		}
+		body::reader body_reader( stream_view stream ) const {
+			return { stream, body_props };
+		}
 		auto read_headers( stream_view stream ) {
 			return headers.read( stream );
 		}
@@ -795,7 +1387,7 @@ namespace xstd::http {
 
 		// Writers.
 		//
-		void write( vec_buffer& buf, method_id req_method = INVALID ) const {
+		void write_start( vec_buffer& buf, bool unframed = false ) const {
 			uint8_t status_buffer[ 3 ] = {};
 			
 			int sit = status <= 99 || status > 999 ? 500 : status;
@@ -805,14 +1397,49 @@ namespace xstd::http {
 			}
 
 			detail::append_into( buf, "HTTP/1.1 ", std::span{ status_buffer }, " ", status_message, "\r\n" );
-			headers.write( buf );
-			body::write( buf, body, req_method, -1 );
+			if ( unframed ) headers.write_unframed( buf );
+			else            headers.write( buf );
+		}
+		void write( vec_buffer& buf, method_id req_method = INVALID ) const {
+			write_start( buf );
+			body::write( buf, body, req_method, status );
+		}
+
+		// Streaming writers, writes the head declaring a chunked body that should be followed by a body::chunked_writer.
+		// - Any Content-Length or Transfer-Encoding set by the user is dropped as the chunked framing replaces it.
+		//
+		void write_head( vec_buffer& buf, method_id req_method = INVALID ) const {
+			write_start( buf, true );
+			body::write_head( buf, req_method, status );
+		}
+		auto write_head( stream_view stream, method_id req_method = INVALID ) const {
+			return stream.write_using( [&]( vec_buffer& buf ) {
+				this->write_head( buf, req_method );
+			} );
 		}
 		auto write( stream_view stream, method_id req_method = INVALID ) const {
 			return stream.write_using( [&]( vec_buffer& buf ) {
 				this->write( buf, req_method );
 			} );
 		}
+
+		// Sends the response, streaming the body from the source if there is one, returns false if the stream was stopped.
+		//
+		job<bool> send( stream_view stream, method_id req_method = INVALID ) const {
+			if ( !body_source ) {
+				co_await write( stream, req_method );
+			} else {
+				co_await write_head( stream, req_method );
+				if ( !body::is_always_empty( req_method, status ) ) {
+					body::chunked_writer writer{ stream };
+					if ( !co_await body_source( writer ) )
+						stream.stop( XSTD_ESTR( "body source aborted" ) );
+					else
+						co_await writer.finish();
+				}
+			}
+			co_return !stream.stopped();
+		}
 		std::string to_string() const {
 			vec_buffer buf{};
 			write( buf );
@@ -826,47 +1453,44 @@ namespace xstd::http {
 
 		// Readers.
 		//
-		job<bool> read_head( stream_view stream, method_id req_method = INVALID ) {
-			// Read the status line.
-			//
-			auto meta = co_await readln( stream );
-			if ( !meta ) {
-				co_return false;
-			}
-			if ( !meta->starts_with( "HTTP/1.1 " ) ) {
-				stream.stop( XSTD_ESTR( "invalid response line: http version" ) );
-				co_return false;
-			}
-			std::string_view status_and_msg{ meta->data() + xstd::strlen( "HTTP/1.1 " ), meta->size() };
-			if ( status_and_msg.size() < 4 || status_and_msg[ 3 ] != ' ' ) {
-				stream.stop( XSTD_ESTR( "invalid response line: status code" ) );
-				co_return false;
-			}
-			status = 0;
-			for ( size_t i = 0; i != 3; i++ ) {
-				if ( '0' <= status_and_msg[ i ] && status_and_msg[ i ] <= '9' ) {
-					status *= 10;
-					status += ( status_and_msg[ i ] - '0' );
-				} else {
-					stream.stop( XSTD_ESTR( "invalid response line: status code" ) );
-					co_return false;
-				}
+		// Applies a completed head and consumes it from the buffer, which is taken over by the headers.
+		//
+		std::optional<exception> apply_head( const head_parser& parser, vec_buffer& buf, method_id req_method = INVALID ) {
+			std::span<const uint8_t> data{ buf.data(), buf.size() };
+			if ( parser.version.view( data ) != "HTTP/1.1" ) {
+				buf.shift( parser.length );
+				return exception{ XSTD_ESTR( "invalid response line: http version" ) };
 			}
-			status_and_msg.remove_prefix( 4 );
-			meta->erase( meta->begin(), meta->begin() + xstd::strlen( "HTTP/1.1 " ) + 4 );
-			status_message = std::move( meta ).value();
+			status = parser.status;
+			status_message = parser.reason.view( data );
 			if ( !is_success( status ) && status_message.empty() )
 				status_message = get_status_message( status );
-
-			// Read the headers, set body properties.
+			headers.adopt_fields( parser, buf.shift_range( parser.length ) );
+			this->body_props = this->get_body_properties( req_method );
+			return std::nullopt;
+		}
+		job<bool> read_head( stream_view stream, method_id req_method = INVALID ) {
+			// Parse the head in-place as it arrives, then consume it.
 			//
-			bool ok = true;
-			if ( auto err = co_await this->read_headers( stream ); err == std::nullopt || err->has_value() ) {
-				ok = false;
-				if ( err ) stream.stop( std::move( *err ) );
+			head_parser parser{ true };
+			auto err = co_await stream.read_until( [ & ]( vec_buffer& buf ) -> std::optional<exception> {
+				std::span<const uint8_t> data{ buf.data(), buf.size() };
+				switch ( parser.feed( data ) ) {
+					case head_parser::incomplete:
+						return std::nullopt;
+					case head_parser::complete:
+						return apply_head( parser, buf, req_method ).value_or( exception{} );
+					default:
+						return exception{ XSTD_ESTR( "invalid response head" ) };
+				}
+			} );
+			if ( !err ) {
+				co_return false;
+			} else if ( err->has_value() ) {
+				stream.stop( std::move( *err ) );
+				co_return false;
 			}
-			this->body_props = this->get_body_properties( req_method );
-			co_return ok;
+			co_return true;
 		}
 		job<bool> read( stream_view stream, method_id req_method = INVALID ) {
 			co_return co_await read_head( stream, req_method ) && co_await read_body( stream );
@@ -940,16 +1564,49 @@ namespace xstd::http {
 
 		// Writers.
 		//
-		void write( vec_buffer& buf ) const {
+		void write_start( vec_buffer& buf, bool unframed = false ) const {
 			detail::append_into( buf, method_map[ size_t( method ) ].second, " ", path, " HTTP/1.1\r\n" );
-			headers.write( buf );
+			if ( unframed ) headers.write_unframed( buf );
+			else            headers.write( buf );
+		}
+		void write( vec_buffer& buf ) const {
+			write_start( buf );
 			body::write( buf, body, method, -1 );
 		}
+
+		// Streaming writers, writes the head declaring a chunked body that should be followed by a body::chunked_writer.
+		// - Any Content-Length or Transfer-Encoding set by the user is dropped as the chunked framing replaces it.
+		//
+		void write_head( vec_buffer& buf ) const {
+			write_start( buf, true );
+			body::write_head( buf, method, -1 );
+		}
+		auto write_head( stream_view stream ) const {
+			return stream.write_using( [&]( vec_buffer& buf ) {
+				this->write_head( buf );
+			} );
+		}
 		auto write( stream_view stream ) const {
 			return stream.write_using( [&]( vec_buffer& buf ) {
 				this->write( buf );
 			} );
 		}
+
+		// Sends the request, streaming the body from the source if there is one, returns false if the stream was stopped.
+		//
+		job<bool> send( stream_view stream ) const {
+			if ( !body_source ) {
+				co_await write( stream );
+			} else {
+				co_await write_head( stream );
+				body::chunked_writer writer{ stream };
+				if ( !co_await body_source( writer ) )
+					stream.stop( XSTD_ESTR( "body source aborted" ) );
+				else
+					co_await writer.finish();
+			}
+			co_return !stream.stopped();
+		}
 		std::string to_string() const {
 			vec_buffer buf{};
 			write( buf );
@@ -963,39 +1620,66 @@ namespace xstd::http {
 
 		// Readers.
 		//
-		job<bool> read_head( stream_view stream ) {
-			// Read the request line.
-			//
-			auto meta = co_await readln( stream );
-			if ( !meta ) {
-				co_return false;
-			}
-			auto [method_name, pathname, version] = split_fwd<3>( *meta, " " );
-			method = find_method( method_name );
-			path = pathname;
-			if ( version != "HTTP/1.1" ) {
-				stream.stop( XSTD_ESTR( "invalid request line: http version" ) );
-				co_return false;
+		// Applies a completed head and consumes it from the buffer, which is taken over by the headers.
+		//
+		std::optional<exception> apply_head( const head_parser& parser, vec_buffer& buf ) {
+			std::span<const uint8_t> data{ buf.data(), buf.size() };
+			method = find_method( parser.method.view( data ) );
+			path = parser.target.view( data );
+			if ( parser.version.view( data ) != "HTTP/1.1" ) {
+				buf.shift( parser.length );
+				return exception{ XSTD_ESTR( "invalid request line: http version" ) };
 			}
 			if ( method == INVALID ) {
-				stream.stop( XSTD_ESTR( "invalid request line: method" ) );
-				co_return false;
+				buf.shift( parser.length );
+				return exception{ XSTD_ESTR( "invalid request line: method" ) };
 			}
-
-			// Read the headers, set body properties.
+			headers.adopt_fields( parser, buf.shift_range( parser.length ) );
+			this->body_props = this->get_body_properties();
+			return std::nullopt;
+		}
+		job<bool> read_head( stream_view stream ) {
+			// Parse the head in-place as it arrives, then consume it.
 			//
-			bool ok = true;
-			if ( auto err = co_await this->read_headers( stream ); err == std::nullopt || err->has_value() ) {
-				ok = false;
-				if ( err ) stream.stop( std::move( *err ) );
+			head_parser parser{ false };
+			auto err = co_await stream.read_until( [ & ]( vec_buffer& buf ) -> std::optional<exception> {
+				std::span<const uint8_t> data{ buf.data(), buf.size() };
+				switch ( parser.feed( data ) ) {
+					case head_parser::incomplete:
+						return std::nullopt;
+					case head_parser::complete:
+						return apply_head( parser, buf ).value_or( exception{} );
+					default:
+						return exception{ XSTD_ESTR( "invalid request head" ) };
+				}
+			} );
+			if ( !err ) {
+				co_return false;
+			} else if ( err->has_value() ) {
+				stream.stop( std::move( *err ) );
+				co_return false;
 			}
-			this->body_props = this->get_body_properties();
-			co_return ok;
+			co_return true;
 		}
 		job<bool> read( stream_view stream ) {
 			co_return co_await read_head( stream ) && co_await read_body( stream );
 		}
 
+		// Sync head parser, expects the entire head to be in the buffer and consumes it.
+		//
+		std::optional<exception> parse_head( vec_buffer& buf ) {
+			std::span<const uint8_t> data{ buf.data(), buf.size() };
+			head_parser parser{ false };
+			switch ( parser.feed( data ) ) {
+				case head_parser::incomplete:
+					return exception{ XSTD_ESTR( "incomplete request head" ) };
+				case head_parser::complete:
+					return apply_head( parser, buf );
+				default:
+					return exception{ XSTD_ESTR( "invalid request head" ) };
+			}
+		}
+
 		// Sync parser.
 		//
 		static request parse( vec_buffer& io ) {
@@ -1073,10 +1757,50 @@ namespace xstd::http {
 	};
 #if XSTD_HAS_TCP
 	struct basic_agent : agent {
+		// Pool limits.
+		//
+		struct pool_options {
+			size_t          max_idle_per_host = 16;   // Idle connections kept per host, excess ones are closed on release.
+			size_t          max_idle =          256;  // Idle connections kept across all hosts.
+			size_t          max_per_host =      0;    // Connections handed out per host at once, further connects wait, 0 for no limit.
+			xstd::duration  idle_timeout =      30s;  // Idle connections older than this are closed.
+		};
+
+		// Pool counters.
+		//
+		struct pool_stats {
+			uint64_t hits =            0;  // Connections reused from the pool.
+			uint64_t misses =          0;  // Connections newly opened.
+			uint64_t waits =           0;  // Connects that had to wait for the per-host limit.
+			uint64_t evictions =       0;  // Idle connections closed due to the timeout or the limits.
+			uint64_t health_failures = 0;  // Idle connections found unusable at checkout.
+			size_t   idle =            0;  // Currently pooled connections.
+			size_t   active =          0;  // Currently handed out connections.
+		};
+
+		// Idle connection and the per-host state, idle list is LIFO so the most recently used socket is reused first and
+		// the front holds the oldest one.
+		//
+		struct idle_connection {
+			unique_stream               socket;
+			timestamp                   since;
+		};
+		struct host_pool {
+			std::vector<idle_connection>    idle;
+			size_t                          active = 0;
+			std::deque<coroutine_handle<>>  waiters;
+		};
+
 		// Lock guarding the overall structure and the connection pool.
 		//
-		xstd::xspinlock<>                                       mtx;
-		robin_hood::unordered_flat_map<uint64_t, unique_stream> connection_pool;
+		xstd::xadaptive_lock<>                              mtx;
+		pool_options                                        options;
+		robin_hood::unordered_flat_map<uint64_t, host_pool> connection_pool;
+		pool_stats                                          counters;
+		bool                                                sweep_scheduled = false;
+
+		basic_agent() = default;
+		basic_agent( pool_options options ) : options( options ) {}
 
 		// Socket wrapper with connection metadata.
 		//
@@ -1090,32 +1814,81 @@ namespace xstd::http {
 			async_buffer& writable() { return socket.writable(); }
 
 			~shared_socket() {
-				if ( !socket || socket.stopped() ) return;
 				if ( auto agent = source.lock() ) {
-					std::lock_guard _g{ agent->mtx };
-					agent->connection_pool.try_emplace( cache_uid, std::move( socket ) );
+					agent->release( cache_uid, std::move( socket ) );
 				}
 			}
 		};
 
+		// Returns a snapshot of the pool counters.
+		//
+		pool_stats stats() {
+			std::lock_guard _g{ mtx };
+			return counters;
+		}
+
+		// Closes all idle connections.
+		//
+		void clear_idle() {
+			std::vector<idle_connection> discard;
+			std::lock_guard _g{ mtx };
+			for ( auto& [uid, host] : connection_pool ) {
+				counters.idle -= host.idle.size();
+				counters.evictions += host.idle.size();
+				for ( auto& c : host.idle )
+					discard.emplace_back( std::move( c ) );
+				host.idle.clear();
+			}
+		}
+
 		// Creates a connection given the hostname or IP.
 		//
 		job<result<unique_stream>> connect( net::ipv4 ip, uint16_t port ) override {
 			uint64_t uid = ( uint64_t( ip.to_integer() ) << 16 ) | port;
 
 			unique_stream result;
-			{
-				std::lock_guard _g{ mtx };
-				auto it = connection_pool.find( uid );
-				if ( it != connection_pool.end() ) {
-					if ( !it->second.stopped() ) {
-						result = std::move( it->second );
+			while ( true ) {
+				std::vector<idle_connection> discard;
+				{
+					std::lock_guard _g{ mtx };
+					auto& host = connection_pool[ uid ];
+
+					// Pop idle connections until a healthy one is found.
+					//
+					while ( !host.idle.empty() ) {
+						auto c = std::move( host.idle.back() );
+						host.idle.pop_back();
+						counters.idle--;
+						if ( is_reusable( c ) ) {
+							result = std::move( c.socket );
+							break;
+						}
+						counters.health_failures++;
+						discard.emplace_back( std::move( c ) );
+					}
+					if ( result ) {
+						counters.hits++;
+						counters.active++;
+						host.active++;
+						break;
 					}
-					connection_pool.erase( it );
+
+					// Open a new connection if under the limit.
+					//
+					if ( !options.max_per_host || host.active < options.max_per_host ) {
+						counters.misses++;
+						counters.active++;
+						host.active++;
+						result = new net::tcp( ip, port );
+						break;
+					}
+					counters.waits++;
 				}
+				discard.clear();
+				co_await slot_awaitable{ this, uid };
 			}
 			co_return new shared_socket{
-				result ? std::move( result ) : new net::tcp( ip, port ),
+				std::move( result ),
 				uid,
 				std::static_pointer_cast<basic_agent>( shared_from_this() )
 			};
@@ -1125,6 +1898,114 @@ namespace xstd::http {
 			if ( !ip ) co_return std::move( ip.status );
 			co_return co_await connect( *ip, port );
 		}
+
+	protected:
+		// Checks whether an idle connection can be reused, a socket that has been closed by the peer, that has
+		// outlived the idle timeout or that has unsolicited data pending cannot carry another request.
+		//
+		bool is_reusable( idle_connection& c ) const {
+			if ( c.socket.stopped() || c.socket.is_shutting_down() )
+				return false;
+			if ( ( c.since + options.idle_timeout ) <= time::now() )
+				return false;
+			async_buffer_locked buf{ c.socket.readable() };
+			return buf.buffer().empty();
+		}
+
+		// Waits until the per-host limit has room or an idle connection is available.
+		//
+		struct slot_awaitable {
+			basic_agent* agent;
+			uint64_t     uid;
+
+			bool await_ready() { return false; }
+			bool await_suspend( coroutine_handle<> hnd ) {
+				std::lock_guard _g{ agent->mtx };
+				auto& host = agent->connection_pool[ uid ];
+				if ( !host.idle.empty() || host.active < agent->options.max_per_host )
+					return false;
+				host.waiters.emplace_back( hnd );
+				return true;
+			}
+			void await_resume() {}
+		};
+
+		// Returns a connection to the pool.
+		//
+		void release( uint64_t uid, unique_stream socket ) {
+			coroutine_handle<> waiter = nullptr;
+			{
+				std::lock_guard _g{ mtx };
+				auto& host = connection_pool[ uid ];
+				host.active--;
+				counters.active--;
+				if ( socket && !socket.stopped() ) {
+					if ( host.idle.size() >= options.max_idle_per_host || counters.idle >= options.max_idle ) {
+						counters.evictions++;
+					} else {
+						host.idle.push_back( { std::move( socket ), time::now() } );
+						counters.idle++;
+						schedule_sweep( options.idle_timeout );
+					}
+				}
+				if ( !host.waiters.empty() ) {
+					waiter = host.waiters.front();
+					host.waiters.pop_front();
+				}
+			}
+			if ( waiter )
+				xstd::chore( waiter );
+		}
+
+		// Schedules the idle eviction on the deferred queue if not already scheduled, must be called with the lock held.
+		//
+		void schedule_sweep( xstd::duration delay ) {
+			if ( std::exchange( sweep_scheduled, true ) )
+				return;
+			xstd::chore( [ weak = weak_from_this() ]
+			{
+				if ( auto self = weak.lock() )
+					std::static_pointer_cast<basic_agent>( self )->sweep();
+			}, delay );
+		}
+
+		// Closes expired idle connections and reschedules itself for the next expiry.
+		//
+		void sweep() {
+			std::vector<idle_connection> discard;
+			std::lock_guard _g{ mtx };
+			sweep_scheduled = false;
+
+			auto now = time::now();
+			auto next = timestamp::max();
+			for ( auto it = connection_pool.begin(); it != connection_pool.end(); ) {
+				auto& host = it->second;
+				auto keep = host.idle.begin();
+				for ( auto& c : host.idle ) {
+					if ( !c.socket.stopped() && now < ( c.since + options.idle_timeout ) ) {
+						if ( &*keep != &c )
+							*keep = std::move( c );
+						++keep;
+					} else {
+						discard.emplace_back( std::move( c ) );
+					}
+				}
+				host.idle.erase( keep, host.idle.end() );
+				if ( !host.idle.empty() ) {
+					next = std::min( next, host.idle.front().since + options.idle_timeout );
+				}
+				if ( host.idle.empty() && !host.active && host.waiters.empty() ) {
+					it = connection_pool.erase( it );
+				} else {
+					++it;
+				}
+			}
+			counters.idle -= discard.size();
+			counters.evictions += discard.size();
+			if ( next != timestamp::max() ) {
+				schedule_sweep( next - now );
+			}
+		}
 	};
 #endif
 
@@ -1136,15 +2017,22 @@ namespace xstd::http {
 		vec_buffer    body = {};
 		http::headers headers = {};
 
+		// Streaming bodies.
+		// - If the source is set, the request body is produced by it in chunks, such requests are only redirected by 303.
+		// - If the sink is set, the final response body is passed to it as it arrives instead of being buffered.
+		//
+		body::source  body_source = {};
+		body::sink    body_sink = {};
+
 		// Agent and optional explicit socket.
 		//
-		std::shared_ptr<agent> agent =  agent::global();
-		stream_view            socket = nullptr;
+		std::shared_ptr<http::agent> agent =  http::agent::global();
+		stream_view                  socket = nullptr;
 
 		// Redirection handling.
 		// - Once the limit is exhaused, response code is returned as is.
 		//
-		int32_t                max_redirects = 8;
+		int32_t                      max_redirects = 8;
 	};
 	inline job<response> fetch( xstd::url url, method_id method = GET, fetch_options&& opt = {} ) {
 		auto        agent = std::move( opt.agent );
@@ -1154,6 +2042,7 @@ namespace xstd::http {
 		// Create the request.
 		//
 		request req{ method, {}, std::move( opt.body ), std::move( opt.headers ) };
+		req.body_source = std::move( opt.body_source );
 		response res = {};
 		while ( true ) {
 			// Determine the protocol.
@@ -1191,29 +2080,44 @@ namespace xstd::http {
 
 			// Send the request.
 			//
-			co_await req.write( stream );
+			co_await req.send( stream );
 
-			// Read the response.
+			// Read the response head, then the body into the sink if this is the final response or into the buffer otherwise.
 			//
-			co_await res.read( stream, req.method );
+			bool redirect = false;
+			if ( co_await res.read_head( stream, req.method ) ) {
+				redirect = get_status_category( res.status ) == status_category::redirecting && --redirects_left > 0;
+				if ( req.body_source && res.status != 303 )
+					redirect = false;
+
+				if ( opt.body_sink && !redirect ) {
+					auto reader = res.body_reader( stream );
+					if ( !co_await reader.pipe( opt.body_sink ) && !stream.stopped() )
+						stream.stop( XSTD_ESTR( "body sink aborted" ) );
+					res.body_props = reader.prop;
+				} else {
+					co_await res.read_body( stream );
+				}
+			}
 			if ( stream.errored() ) {
-				req.connection_error = stream.stop_reason();
+				res.connection_error = stream.stop_reason();
 				break;
 			}
-			else if ( !req.keep_alive() ) {
+			else if ( !req.keep_alive() || !res.keep_alive() ) {
 				stream.stop();
 				stream = {};
 			}
 
 			// Follow redirects where relevant.
 			//
-			if ( get_status_category( res.status ) == status_category::redirecting && --redirects_left > 0 ) {
+			if ( redirect ) {
 				std::string_view target_loc = res.get_header( "Location" );
 				if ( target_loc.empty() ) break;
 
 				if ( res.status == 303 ) {
 					req.method = GET;
 					req.body.clear();
+					req.body_source = {};
 				}
 				if ( target_loc.starts_with( "/" ) ) {
 					url.pathname = target_loc;
@@ -1240,4 +2144,250 @@ namespace xstd::http {
 	inline auto put( xstd::url url, fetch_options&& opt = {} ) { return fetch( std::move( url ), PUT, std::move( opt ) ); }
 	inline auto post( xstd::url url, fetch_options&& opt = {} ) { return fetch( std::move( url ), POST, std::move( opt ) ); }
 	inline auto head( xstd::url url, fetch_options&& opt = {} ) { return fetch( std::move( url ), HEAD, std::move( opt ) ); }
+
+#if XSTD_HAS_TCP
+	// HTTP server options.
+	//
+	struct server_options {
+		size_t              max_head_size = 64_kb; // Limit of the request line and the headers, larger heads are rejected with 431.
+		size_t              max_body_size = 16_mb; // Limit of the request body, larger bodies are rejected with 413.
+		size_t              max_pipeline =  16;    // Requests dispatched per connection ahead of their responses being written.
+		net::socket_options socket =        {};
+	};
+
+	// HTTP/1.1 server, requests are dispatched to the handler as soon as they are parsed so pipelined requests are
+	// processed concurrently, responses are written back in the order the requests arrived.
+	// - Streaming handlers are dispatched after the head and read the body through the reader, the next request is
+	//   parsed once they return with the unread rest of the body discarded, max_body_size is not applied to them.
+	// - Responses with a body source are written with a chunked body produced by it.
+	//
+	struct server {
+		using handler_type =           std::function<job<response>( request )>;
+		using streaming_handler_type = std::function<job<response>( request, body::reader& )>;
+
+		// State shared with the connections, which may outlive the server.
+		//
+		struct shared_state {
+			streaming_handler_type                             handler;
+			server_options                                     options;
+			bool                                               streaming = false;
+			xstd::xspinlock<>                                  lock = {};
+			bool                                               closing = false;
+			robin_hood::unordered_flat_map<void*, stream_view> connections = {};
+		};
+		std::shared_ptr<shared_state>    state;
+		std::unique_ptr<net::tcp_server> listener;
+
+		// Constructed by the address and the handler.
+		//
+		server( net::ipv4 address, uint16_t port, streaming_handler_type handler, server_options options = {} )
+			: state( new shared_state{ .handler = std::move( handler ), .options = options, .streaming = true } ),
+			  listener( std::make_unique<net::tcp_server>( address, port, options.socket ) ) {}
+		server( net::ipv4 address, uint16_t port, handler_type handler, server_options options = {} )
+			: server( address, port, streaming_handler_type{ [ handler = std::move( handler ) ]( request req, body::reader& ) { return handler( std::move( req ) ); } }, options ) {
+			state->streaming = false;
+		}
+		server( uint16_t port, streaming_handler_type handler, server_options options = {} )
+			: server( net::ipv4{}, port, std::move( handler ), options ) {}
+		server( uint16_t port, handler_type handler, server_options options = {} )
+			: server( net::ipv4{}, port, std::move( handler ), options ) {}
+
+		// No copy.
+		//
+		server( const server& ) = delete;
+		server& operator=( const server& ) = delete;
+
+		// Starts accepting connections.
+		//
+		bool listen() {
+			return listener->listen( [ state = state ]( std::unique_ptr<net::tcp> client ) {
+				serve( state, std::move( client ) );
+			} );
+		}
+
+		// Error state of the listener.
+		//
+		bool ok() const { return !listener->stopped(); }
+		exception error() const { return listener->stop_reason(); }
+
+		// Stops listening and drops the open connections.
+		//
+		~server() {
+			listener.reset();
+			std::lock_guard _g{ state->lock };
+			state->closing = true;
+			for ( auto& [k, conn] : state->connections ) {
+				conn.stop( stream_stop_killed, XSTD_ESTR( "server closed" ) );
+			}
+		}
+
+	protected:
+		// Invokes the handler, discards the unread body signalling the connection loop if it is waiting on it, then waits
+		// for the previous response to be written and writes the result.
+		// - The signals are resolved on every path so that a failing handler or write never stalls the pipeline, if the
+		//   handler throws the client gets a 500 and the connection is closed.
+		//
+		static async_task respond( std::shared_ptr<shared_state> st, stream_view stream, request req, promise<> previous, promise<> done, promise<> consumed ) {
+			finally _g{ [ & ] {
+				if ( consumed ) consumed.resolve();
+				done.resolve();
+			} };
+			method_id method = req.method;
+			bool keep_alive = req.keep_alive();
+
+			body::reader reader = req.body_reader( stream );
+			response res = {};
+			bool failed = false;
+#if XSTD_NO_EXCEPTIONS
+			res = co_await st->handler( std::move( req ), reader );
+#else
+			try {
+				res = co_await st->handler( std::move( req ), reader );
+			} catch ( ... ) {
+				res = response{ 500 };
+				failed = true;
+				keep_alive = false;
+			}
+#endif
+			if ( consumed && !failed ) {
+				vec_buffer rest = {};
+				while ( !reader.done() ) {
+					rest.clear();
+					co_await reader.read_some( rest );
+				}
+				if ( reader.failed() && !stream.stopped() )
+					stream.stop( XSTD_ESTR( "invalid request body" ) );
+				consumed.resolve();
+			}
+			if ( previous ) {
+				co_await previous;
+			}
+			if ( !keep_alive ) {
+				res.set_header( "Connection", "close" );
+			}
+			co_await res.send( stream, method );
+			if ( failed ) {
+				stream.shutdown();
+			}
+		}
+
+		// Writes an error response in order and marks the connection for closing.
+		//
+		static async_task reject( stream_view stream, int status, promise<> previous, promise<> done ) {
+			finally _g{ [ & ] { done.resolve(); } };
+			if ( previous ) {
+				co_await previous;
+			}
+			response res{ status, {}, {}, { { "Connection", "close" } } };
+			co_await res.write( stream );
+		}
+
+		// Connection loop.
+		//
+		static async_task serve( std::shared_ptr<shared_state> st, unique_stream socket ) {
+			stream_view stream = socket;
+			{
+				std::lock_guard _g{ st->lock };
+				if ( st->closing ) co_return;
+				st->connections.emplace( stream.ptr, stream );
+			}
+			const auto& opt = st->options;
+
+			std::deque<promise<>> inflight;
+			head_parser parser{ false, opt.max_head_size };
+			while ( !stream.stopped() ) {
+				// Wait for the oldest response if the pipeline is full.
+				//
+				while ( inflight.size() >= std::max<size_t>( opt.max_pipeline, 1 ) ) {
+					co_await inflight.front();
+					inflight.pop_front();
+				}
+				auto previous = inflight.empty() ? promise<>{} : inflight.back();
+				auto done = make_promise();
+
+				// Wait for the head to be complete and parse it in-place, scanning only the newly received bytes.
+				//
+				request req = {};
+				parser.reset();
+				auto head = co_await stream.read_until( [ & ]( vec_buffer& buf ) -> std::optional<int> {
+					std::span<const uint8_t> data{ buf.data(), buf.size() };
+					switch ( parser.feed( data ) ) {
+						case head_parser::incomplete:
+							return std::nullopt;
+						case head_parser::complete:
+							return req.apply_head( parser, buf ) ? 400 : 0;
+						case head_parser::too_large:
+							return 431;
+						default:
+							return 400;
+					}
+				} );
+				if ( !head ) {
+					break;
+				} else if ( *head ) {
+					reject( stream, *head, std::move( previous ), done );
+					inflight.emplace_back( std::move( done ) );
+					break;
+				}
+
+				// Read the body.
+				//
+				auto& props = req.body_props;
+				if ( !st->streaming && props.code == body::raw && props.length > opt.max_body_size ) {
+					reject( stream, 413, std::move( previous ), done );
+					inflight.emplace_back( std::move( done ) );
+					break;
+				}
+				if ( props.code != body::finished && detail::fast_ieq( req.get_header( "Expect" ), "100-continue" ) ) {
+					if ( previous ) co_await previous;
+					co_await stream.write( std::span{ (const uint8_t*) "HTTP/1.1 100 Continue\r\n\r\n", 25 } );
+				}
+
+				// Dispatch streaming handlers right away, waiting for them to be done with the body before parsing the next head.
+				//
+				if ( st->streaming ) {
+					bool keep_alive = req.keep_alive();
+					promise<> consumed = props.code != body::finished ? make_promise() : promise<>{};
+					respond( st, stream, std::move( req ), std::move( previous ), done, consumed );
+					inflight.emplace_back( std::move( done ) );
+					if ( !keep_alive ) break;
+					if ( consumed ) co_await consumed;
+					continue;
+				}
+				if ( props.code == body::chunked ) {
+					if ( !co_await body::read_chunked( req.body, stream, opt.max_body_size ) ) {
+						if ( !stream.stopped() ) {
+							reject( stream, 413, std::move( previous ), done );
+							inflight.emplace_back( std::move( done ) );
+						}
+						break;
+					}
+					props = { req.body.size(), body::finished };
+				} else if ( !co_await req.read_body( stream ) ) {
+					break;
+				}
+
+				// Dispatch the request, stop reading if the connection is closing after it.
+				//
+				bool keep_alive = req.keep_alive();
+				respond( st, stream, std::move( req ), std::move( previous ), done, {} );
+				inflight.emplace_back( std::move( done ) );
+				if ( !keep_alive ) break;
+			}
+
+			// Wait for the pending responses, close the write side and wait for the peer to close.
+			//
+			if ( !inflight.empty() ) {
+				co_await inflight.back();
+			}
+			if ( !stream.stopped() ) {
+				stream.shutdown();
+				co_await stream.wait_until_shutdown();
+			}
+
+			std::lock_guard _g{ st->lock };
+			st->connections.erase( stream.ptr );
+		}
+	};
+#endif
 };
\ No newline at end of file
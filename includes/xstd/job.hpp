@@ -17,18 +17,19 @@ namespace xstd {
 		};
 	};
 
-	// Simple job coroutine with no exceptions or sync interface.
+	// Simple job coroutine with a sync interface, exceptions are rethrown to the awaiter.
 	//
 	template<typename T = void>
 	struct job {
 		struct promise_type {
 			coroutine_handle<> continuation = {};
 			std::optional<T>* placement = nullptr;
+			std::exception_ptr* exception = nullptr;
 
 			FORCE_INLINE inline job get_return_object() { return *this; }
 			FORCE_INLINE inline suspend_always initial_suspend() noexcept { return {}; }
 			FORCE_INLINE inline detail::job_awaitable<promise_type> final_suspend() noexcept { return {}; }
-			XSTDC_UNHANDLED_RETHROW;
+			XSTDC_UNHANDLED_FORWARD( exception );
 			template<typename V>
 			FORCE_INLINE inline void return_value( V&& v ) {
 				if ( placement )
@@ -38,15 +39,19 @@ namespace xstd {
 		struct awaiter {
 			unique_coroutine<promise_type> handle = nullptr;
 			std::optional<T> placement = std::nullopt;
+			std::exception_ptr exception = nullptr;
 
 			FORCE_INLINE inline bool await_ready() noexcept { return false; }
 			FORCE_INLINE inline coroutine_handle<> await_suspend( coroutine_handle<> hnd ) noexcept {
 				auto& pr = handle.promise();
 				pr.continuation = hnd;
 				pr.placement = &placement;
+				pr.exception = &exception;
 				return handle.hnd;
 			}
-			FORCE_INLINE inline T await_resume() noexcept {
+			FORCE_INLINE inline T await_resume() {
+				if ( exception ) [[unlikely]]
+					std::rethrow_exception( std::move( exception ) );
 				strong_assume( placement.has_value() );
 				return std::move( placement ).value();
 			}
@@ -80,9 +85,11 @@ namespace xstd {
 		//
 		FORCE_INLINE T run( bool spin = false ) {
 			std::optional<T> placement;
+			std::exception_ptr exception;
 			auto& pr = handle.promise();
 			pr.continuation = noop_coroutine();
 			pr.placement = &placement;
+			pr.exception = &exception;
 			handle();
 			if ( spin ) {
 				for ( size_t i = 0; !handle.done(); ++i ) [[unlikely]] {
@@ -92,6 +99,8 @@ namespace xstd {
 			} else {
 				fassert( handle.done() );
 			}
+			if ( exception ) [[unlikely]]
+				std::rethrow_exception( std::move( exception ) );
 			strong_assume( placement.has_value() );
 			return std::move( placement ).value();
 		}
@@ -112,21 +121,29 @@ namespace xstd {
 	struct job<void> {
 		struct promise_type {
 			coroutine_handle<> continuation = {};
+			std::exception_ptr* exception = nullptr;
 
 			FORCE_INLINE inline job get_return_object() { return *this; }
 			FORCE_INLINE inline suspend_always initial_suspend() noexcept { return {}; }
 			FORCE_INLINE inline detail::job_awaitable<promise_type> final_suspend() noexcept { return {}; }
-			XSTDC_UNHANDLED_RETHROW;
+			XSTDC_UNHANDLED_FORWARD( exception );
 			FORCE_INLINE inline void return_void() {}
 		};
 		struct awaiter {
 			unique_coroutine<promise_type> handle;
+			std::exception_ptr exception = nullptr;
+
 			FORCE_INLINE inline bool await_ready() noexcept { return false; }
 			FORCE_INLINE inline coroutine_handle<> await_suspend( coroutine_handle<> hnd ) noexcept {
-				handle.promise().continuation = hnd;
+				auto& pr = handle.promise();
+				pr.continuation = hnd;
+				pr.exception = &exception;
 				return handle.hnd;
 			}
-			FORCE_INLINE inline void await_resume() const noexcept {}
+			FORCE_INLINE inline void await_resume() {
+				if ( exception ) [[unlikely]]
+					std::rethrow_exception( std::move( exception ) );
+			}
 		};
 		inline awaiter operator co_await() && noexcept { return { std::move( handle ) }; }
 
@@ -156,8 +173,10 @@ namespace xstd {
 		// Executes the job synchronously, waits for the result.
 		//
 		FORCE_INLINE void run( bool spin = false ) {
+			std::exception_ptr exception;
 			auto& pr = handle.promise();
 			pr.continuation = noop_coroutine();
+			pr.exception = &exception;
 			handle();
 			if ( spin ) {
 				for ( size_t i = 0; !handle.done(); ++i ) [[unlikely]] {
@@ -167,6 +186,8 @@ namespace xstd {
 			} else {
 				fassert( handle.done() );
 			}
+			if ( exception ) [[unlikely]]
+				std::rethrow_exception( std::move( exception ) );
 		}
 
 		// Tails into a job from another coroutine discarding the result.
@@ -13,8 +13,8 @@ namespace xstd::encode
 
 	// Define generic encoder and decoder.
 	//
-	template<Integral T>
-	inline static void leb128( std::vector<uint8_t>& out, T value )
+	template<Integral T, typename C = std::vector<uint8_t>>
+	inline static void leb128( C& out, T value )
 	{
 		if constexpr ( !Same<T, bool> )
 		{
@@ -104,10 +104,38 @@ namespace xstd::encode
 		std::vector<uint8_t> result;
 		result.reserve( values.size() * leb_max_size<T> );
 
-		// Encode every value and return.
+		// Encode every value and return, blocks of single byte values are packed directly.
 		//
-		for ( T value : values )
-			leb128<T>( result, value );
+		size_t n = 0;
+		if constexpr ( !Same<T, bool> )
+		{
+			constexpr size_t block = impl::index_block;
+			for ( ; ( n + block ) <= values.size(); n += block )
+			{
+				bool single = true;
+				for ( size_t i = 0; i != block; i++ )
+				{
+					if constexpr ( Signed<T> )
+						single &= ( values[ n + i ] >= -64 ) & ( values[ n + i ] < 64 );
+					else
+						single &= values[ n + i ] < 128;
+				}
+				if ( single )
+				{
+					size_t pos = result.size();
+					uninitialized_resize( result, pos + block );
+					for ( size_t i = 0; i != block; i++ )
+						result[ pos + i ] = uint8_t( values[ n + i ] ) & 0x7F;
+				}
+				else
+				{
+					for ( size_t i = 0; i != block; i++ )
+						leb128<T>( result, values[ n + i ] );
+				}
+			}
+		}
+		for ( ; n != values.size(); n++ )
+			leb128<T>( result, values[ n ] );
 		return result;
 	}
 	template<Integral T, typename It1, typename It2>
@@ -118,9 +146,51 @@ namespace xstd::encode
 		std::vector<T> result;
 		result.reserve( std::distance( begin, end ) );
 
-		// Read until we reach the end, indicate failure by returning null.
+		// If the input is contiguous, decode blocks of single byte values directly.
 		//
 		auto it = begin;
+		if constexpr ( !Same<T, bool> && std::contiguous_iterator<std::remove_cvref_t<It1>> && Same<std::remove_cvref_t<It1>, std::remove_cvref_t<It2>> )
+		{
+			if constexpr ( sizeof( *it ) == 1 )
+			{
+				constexpr size_t block = impl::index_block;
+				const uint8_t* base = ( const uint8_t* ) std::to_address( begin );
+				const uint8_t* p = base;
+				const uint8_t* limit = ( const uint8_t* ) std::to_address( end );
+				while ( size_t( limit - p ) >= block )
+				{
+					// Continuation bits are the inverse of index terminators, consume the run before the first.
+					//
+					uint32_t cont = impl::index_terminators( p );
+					size_t run = cont ? size_t( lsb( cont ) ) : block;
+					size_t pos = result.size();
+					uninitialized_resize( result, pos + run );
+					T* out = result.data() + pos;
+					for ( size_t i = 0; i != run; i++ )
+					{
+						if constexpr ( Signed<T> )
+							out[ i ] = T( int8_t( p[ i ] << 1 ) >> 1 );
+						else
+							out[ i ] = T( p[ i ] );
+					}
+					p += run;
+
+					// Decode the multi-byte value.
+					//
+					if ( cont )
+					{
+						if ( auto val = rleb128<T>( p, limit ) )
+							result.emplace_back( *val );
+						else
+							return {};
+					}
+				}
+				it += ( p - base );
+			}
+		}
+
+		// Read until we reach the end, indicate failure by returning null.
+		//
 		while ( it != end )
 		{
 			if ( auto val = rleb128<T>( it, end ) )
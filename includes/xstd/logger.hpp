@@ -8,6 +8,9 @@
 #include <functional>
 #include <cstdarg>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <tuple>
 #include "formatting.hpp"
 #include "time.hpp"
 #include "intrinsics.hpp"
@@ -24,6 +27,9 @@
 // XSTD_CON_MSG_DST: If set, changes the generic logging destination from stdout to the given FILE*.
 // XSTD_CON_IFLUSH: If set, instantaneously flushes the file after every message.
 // XSTD_CON_SCOPED: If set, enables padding/scope handling.
+// XSTD_CON_ASYNC: If set, messages are recorded into per-thread rings and formatted/written by a background thread.
+// XSTD_CON_ASYNC_RING: Size of the per-thread ring in bytes, must be a power of two.
+// XSTD_CON_ASYNC_BLOCK: If set, producers wait for space when their ring is full instead of dropping the message.
 //
 
 #ifndef XSTD_CON_THREAD_LOCAL
@@ -53,6 +59,18 @@
 #ifndef XSTD_CON_SCOPED
 	#define XSTD_CON_SCOPED 0
 #endif
+#ifndef XSTD_CON_ASYNC
+	#define XSTD_CON_ASYNC 0
+#endif
+#ifndef XSTD_CON_ASYNC_RING
+	#define XSTD_CON_ASYNC_RING ( 64 * 1024 )
+#endif
+#ifndef XSTD_CON_ASYNC_BLOCK
+	#define XSTD_CON_ASYNC_BLOCK 0
+#endif
+#if XSTD_CON_ASYNC && XSTD_CON_SCOPED
+	#error "Asynchronous logging does not support scope handling."
+#endif
 #ifdef XSTD_CON_ERROR_REDIRECT
 	#if XSTD_CON_ERROR_NOMSG
 		extern "C" void  XSTD_CON_ERROR_REDIRECT [[noreturn]] ();
@@ -313,8 +331,421 @@ namespace xstd
 #endif
 			return out_cnt;
 		}
+
+#if XSTD_CON_ASYNC
+		// Single producer single consumer ring of log records owned by a thread.
+		//
+		struct async_ring
+		{
+			static constexpr size_t capacity = XSTD_CON_ASYNC_RING;
+			static_assert( ( capacity & ( capacity - 1 ) ) == 0, "Ring size must be a power of two." );
+
+			alignas( 64 ) std::atomic<size_t> head = 0; // Written by the producer.
+			alignas( 64 ) std::atomic<size_t> tail = 0; // Written by the consumer.
+			std::atomic<bool>                 closed = false;
+			async_ring*                       next = nullptr;
+			alignas( 64 ) uint8_t             data[ capacity ];
+		};
+
+		// Record layout, followed by the payload replayed by the function.
+		//
+		using async_replay_fn = void( * )( FILE* dst, const uint8_t* payload );
+		struct async_record
+		{
+			uint32_t        size;
+			console_color   color;
+			FILE*           dst;
+			async_replay_fn fn;
+		};
+		inline constexpr size_t async_align = alignof( async_record );
+
+		// Background writer.
+		//
+		struct async_backend
+		{
+			std::mutex               mtx;
+			std::condition_variable  cv;
+			std::atomic<async_ring*> rings = nullptr;
+			std::atomic<bool>        sleeping = false;
+			std::atomic<size_t>      flush_requested = 0;
+			std::atomic<size_t>      flush_completed = 0;
+			std::atomic<size_t>      dropped = 0;
+
+			async_backend()
+			{
+				std::thread( [ this ] { run(); } ).detach();
+				std::atexit( [ ] { async_backend::get().flush(); } );
+			}
+			static async_backend& get()
+			{
+				static async_backend* instance = new async_backend();
+				return *instance;
+			}
+
+			// Wakes the writer if it is waiting. The fence pairs with the one in run() so that either the
+			// writer sees the published record or we see it sleeping, taking the lock then guarantees that it
+			// has started waiting before the notification is sent.
+			//
+			void notify()
+			{
+				std::atomic_thread_fence( std::memory_order::seq_cst );
+				if ( sleeping.load( std::memory_order::relaxed ) )
+				{
+					std::lock_guard _g{ mtx };
+					cv.notify_all();
+				}
+			}
+
+			// Returns whether any ring has records that are not yet drained, must be called with the lock held.
+			//
+			bool pending() const
+			{
+				for ( auto* ring = rings.load( std::memory_order::acquire ); ring; ring = ring->next )
+					if ( ring->head.load( std::memory_order::relaxed ) != ring->tail.load( std::memory_order::relaxed ) )
+						return true;
+				return false;
+			}
+
+			// Waits until every record submitted before the call is written and flushed.
+			//
+			void flush()
+			{
+				size_t target = ++flush_requested;
+				std::unique_lock lock{ mtx };
+				cv.notify_all();
+				cv.wait( lock, [ & ] { return flush_completed.load() >= target; } );
+			}
+
+			// Writes all pending records of the ring, returns whether anything was written.
+			//
+			static bool drain( async_ring& ring )
+			{
+				size_t tail = ring.tail.load( std::memory_order::relaxed );
+				size_t head = ring.head.load( std::memory_order::acquire );
+				if ( tail == head )
+					return false;
+				while ( tail != head )
+				{
+					size_t offset = tail & ( async_ring::capacity - 1 );
+					if ( ( async_ring::capacity - offset ) < sizeof( async_record ) )
+					{
+						tail += async_ring::capacity - offset;
+						continue;
+					}
+					auto* rec = ( const async_record* ) &ring.data[ offset ];
+					if ( rec->fn )
+					{
+						fputs( translate_color( rec->color ), rec->dst );
+						rec->fn( rec->dst, ( const uint8_t* ) ( rec + 1 ) );
+						if ( rec->color != CON_DEF )
+							fputs( translate_color( CON_DEF ), rec->dst );
+					}
+					tail += rec->size;
+				}
+				ring.tail.store( tail, std::memory_order::release );
+				return true;
+			}
+
+			void run()
+			{
+				while ( true )
+				{
+					size_t request = flush_requested.load();
+
+					// Drain every ring, free the ones whose thread has exited.
+					//
+					bool written = false;
+					async_ring* prev = nullptr;
+					for ( auto* ring = rings.load( std::memory_order::acquire ); ring; )
+					{
+						bool closed = ring->closed.load( std::memory_order::acquire );
+						written |= drain( *ring );
+						auto* next = ring->next;
+						if ( closed )
+						{
+							std::lock_guard _g{ mtx };
+							if ( prev ) 
+							{
+								prev->next = next;
+							}
+							else
+							{
+								async_ring* expected = ring;
+								if ( !rings.compare_exchange_strong( expected, next ) )
+								{
+									// A ring was pushed in front of us, find our predecessor.
+									//
+									for ( prev = expected; prev->next != ring; prev = prev->next );
+									prev->next = next;
+								}
+							}
+							delete ring;
+						}
+						else
+						{
+							prev = ring;
+						}
+						ring = next;
+					}
+					if ( written )
+						fflush( nullptr );
+
+					// Signal the flush waiters and blocked producers, wait for more work.
+					//
+					std::unique_lock lock{ mtx };
+					if ( flush_completed.load() != request )
+					{
+						flush_completed.store( request );
+						cv.notify_all();
+					}
+					if ( !written && flush_requested.load() == request )
+					{
+						sleeping.store( true, std::memory_order::relaxed );
+						std::atomic_thread_fence( std::memory_order::seq_cst );
+						if ( !pending() )
+							cv.wait_for( lock, 10ms );
+						sleeping.store( false, std::memory_order::relaxed );
+					}
+				}
+			}
+
+			// Returns the ring of the calling thread.
+			//
+			struct ring_owner
+			{
+				async_ring* ring = nullptr;
+				~ring_owner() { if ( ring ) ring->closed.store( true, std::memory_order::release ); }
+			};
+			async_ring& local_ring()
+			{
+				static thread_local ring_owner owner = {};
+				if ( !owner.ring ) [[unlikely]]
+				{
+					owner.ring = new async_ring();
+					std::lock_guard _g{ mtx };
+					owner.ring->next = rings.load( std::memory_order::relaxed );
+					rings.store( owner.ring, std::memory_order::release );
+				}
+				return *owner.ring;
+			}
+		};
+
+		// Argument packing, strings consumed by a %s conversion are copied into the record and any other pointer is
+		// stored as is. Copies are aligned to the character type, the records themselves are aligned to async_align.
+		//
+		template<typename T>
+		concept AsyncStringArgument = Pointer<T> && Char<std::remove_cv_t<std::remove_pointer_t<T>>>;
+		template<AsyncStringArgument T>
+		using async_char_t = std::remove_cv_t<std::remove_pointer_t<T>>;
+		inline constexpr uint32_t async_null_string = UINT32_MAX;
+		inline constexpr uint32_t async_raw_pointer = UINT32_MAX - 1;
+
+		// Returns a mask of the arguments consumed by a string conversion, arguments past the first 64 or any
+		// in a format using positional arguments are assumed to be strings.
+		//
+		inline uint64_t async_string_args( const char* fmt_str )
+		{
+			uint64_t mask = 0;
+			size_t   n =    0;
+			auto consume = [ & ] ( bool is_string ) { mask |= uint64_t( is_string && n < 64 ) << ( n & 63 ); n++; };
+			while ( ( fmt_str = strchr( fmt_str, '%' ) ) )
+			{
+				if ( *++fmt_str == '%' )
+				{
+					fmt_str++;
+					continue;
+				}
+				for ( ; *fmt_str && strchr( "-+ #0'.123456789*hlLqjzt$", *fmt_str ); fmt_str++ )
+				{
+					if ( *fmt_str == '$' )
+						return ~0ull;
+					if ( *fmt_str == '*' )
+						consume( false );
+				}
+				if ( !*fmt_str )
+					break;
+				consume( *fmt_str == 's' || *fmt_str == 'S' );
+				fmt_str++;
+			}
+			return n >= 64 ? ( mask | ( ~0ull << 63 ) ) : mask;
+		}
+		FORCE_INLINE inline bool async_copies( uint64_t strings, size_t n )
+		{
+			return n >= 64 || ( ( strings >> n ) & 1 );
+		}
+
+		template<typename T>
+		FORCE_INLINE inline size_t async_arg_size( const T& value, bool copy )
+		{
+			if constexpr ( AsyncStringArgument<T> )
+			{
+				if ( !copy || !value )
+					return sizeof( uint32_t ) + sizeof( T );
+				return sizeof( uint32_t ) + alignof( async_char_t<T> ) - 1 + ( std::char_traits<async_char_t<T>>::length( value ) + 1 ) * sizeof( async_char_t<T> );
+			}
+			else
+			{
+				return sizeof( T );
+			}
+		}
+		template<typename T>
+		FORCE_INLINE inline uint8_t* async_arg_write( uint8_t* out, const T& value, bool copy )
+		{
+			if constexpr ( AsyncStringArgument<T> )
+			{
+				static_assert( alignof( async_char_t<T> ) <= async_align, "Record alignment is not sufficient for the string." );
+
+				// Length is stored in bytes including the terminator, so the reader can skip without knowing the unit size.
+				//
+				if ( !copy || !value )
+				{
+					uint32_t tag = value ? async_raw_pointer : async_null_string;
+					memcpy( out, &tag, sizeof( uint32_t ) );
+					memcpy( out + sizeof( uint32_t ), &value, sizeof( T ) );
+					return out + sizeof( uint32_t ) + sizeof( T );
+				}
+				uint32_t length = uint32_t( ( std::char_traits<async_char_t<T>>::length( value ) + 1 ) * sizeof( async_char_t<T> ) );
+				memcpy( out, &length, sizeof( uint32_t ) );
+				out = align_up( out + sizeof( uint32_t ), alignof( async_char_t<T> ) );
+				memcpy( out, value, length );
+				return out + length;
+			}
+			else
+			{
+				memcpy( out, &value, sizeof( T ) );
+				return out + sizeof( T );
+			}
+		}
+		template<typename T>
+		FORCE_INLINE inline T async_arg_read( const uint8_t*& in )
+		{
+			if constexpr ( AsyncStringArgument<T> )
+			{
+				uint32_t length;
+				memcpy( &length, in, sizeof( uint32_t ) );
+				in += sizeof( uint32_t );
+				if ( length == async_null_string || length == async_raw_pointer )
+				{
+					T result;
+					memcpy( &result, in, sizeof( T ) );
+					in += sizeof( T );
+					return result;
+				}
+				in = align_up( in, alignof( async_char_t<T> ) );
+				T result = ( T ) in;
+				in += length;
+				return result;
+			}
+			else
+			{
+				T result;
+				memcpy( &result, in, sizeof( T ) );
+				in += sizeof( T );
+				return result;
+			}
+		}
+		template<typename... Tx>
+		inline void async_replay( FILE* dst, const uint8_t* payload )
+		{
+			const char* fmt_str = ( const char* ) payload;
+			if constexpr ( sizeof...( Tx ) != 0 )
+			{
+				payload += strlen( fmt_str ) + 1;
+				std::tuple<Tx...> args{ async_arg_read<Tx>( payload )... };
+				std::apply( [ & ] ( auto... values ) { fprintf( dst, fmt_str, values... ); }, args );
+			}
+			else
+			{
+				fputs( fmt_str, dst );
+			}
+		}
+
+		// Records the message into the calling thread's ring. Since the message is formatted by the background writer,
+		// returns 0 rather than the number of characters written unless it falls back to the synchronous path.
+		//
+		template<typename... Tx>
+		inline int log_async( FILE* dst, console_color color, const char* fmt_str, Tx... args )
+		{
+			auto& backend = async_backend::get();
+			auto& ring = backend.local_ring();
+
+			// Calculate the record size, messages that do not fit are written synchronously.
+			//
+			[[maybe_unused]] uint64_t strings = sizeof...( Tx ) ? async_string_args( fmt_str ) : 0;
+			[[maybe_unused]] size_t arg_index = 0;
+			size_t fmt_length = strlen( fmt_str ) + 1;
+			size_t length = sizeof( async_record ) + fmt_length;
+			( ( length += async_arg_size( args, async_copies( strings, arg_index++ ) ) ), ... );
+			length = ( length + async_align - 1 ) & ~( async_align - 1 );
+			if ( length > ( async_ring::capacity / 2 ) ) [[unlikely]]
+			{
+				backend.flush();
+				return log_w<sizeof...( Tx ) != 0>( dst, color, fmt_str, args... );
+			}
+
+			// Reserve the space, padding the end of the ring if necessary.
+			//
+			size_t head = ring.head.load( std::memory_order::relaxed );
+			size_t offset = head & ( async_ring::capacity - 1 );
+			size_t padding = ( async_ring::capacity - offset ) < length ? async_ring::capacity - offset : 0;
+			while ( ( async_ring::capacity - ( head - ring.tail.load( std::memory_order::acquire ) ) ) < ( padding + length ) )
+			{
+#if XSTD_CON_ASYNC_BLOCK
+				backend.cv.notify_all();
+				std::this_thread::yield();
+#else
+				backend.dropped.fetch_add( 1, std::memory_order::relaxed );
+				backend.notify();
+				return 0;
+#endif
+			}
+			if ( padding )
+			{
+				if ( padding >= sizeof( async_record ) )
+					*( async_record* ) &ring.data[ offset ] = { uint32_t( padding ), CON_DEF, nullptr, nullptr };
+				head += padding;
+				offset = 0;
+			}
+
+			// Write the record and publish it.
+			//
+			auto* rec = ( async_record* ) &ring.data[ offset ];
+			*rec = { uint32_t( length ), color, dst, &async_replay<Tx...> };
+			uint8_t* it = ( uint8_t* ) ( rec + 1 );
+			memcpy( it, fmt_str, fmt_length );
+			it += fmt_length;
+			arg_index = 0;
+			( ( it = async_arg_write( it, args, async_copies( strings, arg_index++ ) ) ), ... );
+			ring.head.store( head + length, std::memory_order::release );
+			backend.notify();
+			return 0;
+		}
+#endif
 	};
 
+	// Waits until all messages logged so far are written and flushes the destinations.
+	//
+	inline void log_flush()
+	{
+#if XSTD_CON_ASYNC
+		impl::async_backend::get().flush();
+#else
+		fflush( XSTD_CON_MSG_DST );
+		fflush( XSTD_CON_ERR_DST );
+#endif
+	}
+
+	// Returns the number of messages dropped due to a full ring.
+	//
+	inline size_t log_dropped()
+	{
+#if XSTD_CON_ASYNC
+		return impl::async_backend::get().dropped.load( std::memory_order::relaxed );
+#else
+		return 0;
+#endif
+	}
+
 #if !XSTD_CON_NO_LOGS
 	// Generic logger.
 	//
@@ -322,7 +753,11 @@ namespace xstd
 	FORCE_INLINE inline int flog( FILE* dst, console_color color, const char* fmt_str, Tx&&... ps )
 	{
 		fmt::impl::format_buffer_for<std::decay_t<Tx>...> buf = {};
+#if XSTD_CON_ASYNC
+		return impl::log_async( dst, color, fmt_str, fmt::fix_parameter( buf, std::forward<Tx>( ps ) )... );
+#else
 		return impl::log_w<sizeof...( Tx ) != 0>( dst, color, fmt_str, fmt::fix_parameter( buf, std::forward<Tx>( ps ) )... );
+#endif
 	}
 	template<console_color color = CON_DEF, typename... Tx>
 	FORCE_INLINE inline int flog( FILE* dst, const char* fmt_str, Tx&&... ps )
@@ -453,8 +888,7 @@ namespace xstd
 
 		// Flush the files.
 		//
-		fflush( XSTD_CON_MSG_DST );
-		fflush( XSTD_CON_ERR_DST );
+		log_flush();
 
 		// Unlock if previously locked.
 		//
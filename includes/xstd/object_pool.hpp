@@ -4,9 +4,44 @@
 #include "plf_colony.hpp"
 #include "assert.hpp"
 #include <bit>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+// [[Configuration]]
+// XSTD_POOL_MAGAZINES: If set, thread-safe pools keep per-thread magazines of free blocks.
+//
+#ifndef XSTD_POOL_MAGAZINES
+	#define XSTD_POOL_MAGAZINES 1
+#endif
 
 namespace xstd
 {
+	// Pool statistics.
+	//
+	struct object_pool_stats
+	{
+		size_t hits =           0; // Served from the thread's magazine.
+		size_t remote_refills = 0; // Magazine refilled from blocks freed by other threads.
+		size_t colony_refills = 0; // Magazine refilled from the colony under the lock.
+		size_t flushes =        0; // Half of a full magazine returned to the shared list.
+		size_t allocations =    0;
+		size_t deallocations =  0;
+
+		double hit_rate() const { return allocations ? double( hits ) / double( allocations ) : 1.0; }
+		object_pool_stats& operator+=( const object_pool_stats& o )
+		{
+			hits +=           o.hits;
+			remote_refills += o.remote_refills;
+			colony_refills += o.colony_refills;
+			flushes +=        o.flushes;
+			allocations +=    o.allocations;
+			deallocations +=  o.deallocations;
+			return *this;
+		}
+	};
+
 	// Implements an object pool that can be used to allocate fixed-size elements in a fast manner.
 	//
 	template<size_t Length, size_t Align, bool ThreadSafe = false>
@@ -18,17 +53,272 @@ namespace xstd
 		static constexpr size_t alloc_size =    Length;
 		static constexpr size_t alloc_align =   Align;
 		static constexpr bool is_thread_safe =  ThreadSafe;
+		static constexpr bool use_magazines =   ThreadSafe && XSTD_POOL_MAGAZINES && Length >= sizeof( void* ) && Align >= alignof( void* );
+		static constexpr size_t magazine_size = 64;
 		
 		// Colony used as an allocator, lock and the allocation counter.
+		// - If magazines are used, the counter includes blocks cached by the threads.
 		//
 		plf::colony<element_type> colony;
-		spinlock                  lock;
-		size_t                    num_allocations;
+		adaptive_lock             lock;
+		size_t                    num_allocations = 0;
+
+		// Per-thread magazines, freed blocks beyond their capacity are returned to a lock-free list
+		// which is consumed by whichever thread runs out next.
+		//
+		struct free_node { free_node* next; };
+		struct magazine
+		{
+			std::atomic<basic_object_pool*> owner = nullptr;
+			magazine*                       next_registered = nullptr;
+			free_node*                      spill = nullptr;
+			size_t                          count = 0;
+			void*                           items[ magazine_size ];
+
+			// Owner-written, racy-read statistics.
+			//
+			std::atomic<size_t> hits = 0, remote_refills = 0, colony_refills = 0, flushes = 0, allocations = 0, deallocations = 0;
+			FORCE_INLINE static void bump( std::atomic<size_t>& c ) { c.store( c.load( std::memory_order::relaxed ) + 1, std::memory_order::relaxed ); }
+			object_pool_stats stats() const
+			{
+				return {
+					hits.load( std::memory_order::relaxed ), remote_refills.load( std::memory_order::relaxed ),
+					colony_refills.load( std::memory_order::relaxed ), flushes.load( std::memory_order::relaxed ),
+					allocations.load( std::memory_order::relaxed ), deallocations.load( std::memory_order::relaxed )
+				};
+			}
+		};
+		struct thread_cache
+		{
+			std::vector<std::unique_ptr<magazine>> list;
+			magazine*                              last = nullptr;
+			~thread_cache()
+			{
+				// Claim each magazine against a concurrent pool destructor, only the winner may touch it.
+				//
+				for ( auto& m : list )
+					if ( auto* pool = m->owner.exchange( nullptr, std::memory_order::acq_rel ) )
+						pool->release( m.get() );
+			}
+		};
+		static inline thread_local thread_cache tls_cache = {};
+
+		std::atomic<free_node*> returned = nullptr;
+		magazine*               magazines = nullptr;
+		object_pool_stats       retired_stats = {};
+
+		// Set under the lock once destruction begins, the destructor waits for the releases of the magazines
+		// exiting threads have claimed before it.
+		//
+		bool                    dying = false;
+		std::atomic<size_t>     pending_releases = 0;
+
+		basic_object_pool() = default;
+		basic_object_pool( const basic_object_pool& ) = delete;
+		basic_object_pool& operator=( const basic_object_pool& ) = delete;
+		~basic_object_pool()
+		{
+			if constexpr ( use_magazines )
+			{
+				// Detach the magazines, the owning thread may free one as soon as it is unclaimed so read the link first.
+				// The ones already claimed by exiting threads are kept registered for their release to unlink.
+				//
+				{
+					std::lock_guard _g{ lock };
+					dying = true;
+					magazine* claimed = nullptr;
+					size_t count = 0;
+					for ( auto* it = magazines; it; )
+					{
+						auto* next = it->next_registered;
+						if ( it->owner.exchange( nullptr, std::memory_order::acq_rel ) != this )
+						{
+							it->next_registered = std::exchange( claimed, it );
+							count++;
+						}
+						it = next;
+					}
+					magazines = claimed;
+					pending_releases.store( count, std::memory_order::relaxed );
+				}
+				while ( pending_releases.load( std::memory_order::acquire ) )
+					yield_cpu();
+			}
+		}
+
+		// Magazine helpers.
+		//
+		FORCE_INLINE magazine& local_magazine()
+		{
+			auto& cache = tls_cache;
+			if ( cache.last && cache.last->owner.load( std::memory_order::relaxed ) == this ) [[likely]]
+				return *cache.last;
+			return find_magazine( cache );
+		}
+		COLD magazine& find_magazine( thread_cache& cache )
+		{
+			// Look up an existing entry, dropping the ones of destroyed pools.
+			//
+			std::erase_if( cache.list, [ & ] ( auto& m ) { return m.get() != cache.last && !m->owner.load( std::memory_order::relaxed ); } );
+			for ( auto& m : cache.list )
+				if ( m->owner.load( std::memory_order::relaxed ) == this )
+					return *( cache.last = m.get() );
+
+			// Create and register a new magazine.
+			//
+			auto* m = cache.list.emplace_back( std::make_unique<magazine>() ).get();
+			m->owner.store( this, std::memory_order::relaxed );
+			std::lock_guard _g{ lock };
+			m->next_registered = std::exchange( magazines, m );
+			return *( cache.last = m );
+		}
+		NO_INLINE void* refill( magazine& m )
+		{
+			// Take every block freed by the other threads.
+			//
+			if ( auto* list = returned.exchange( nullptr, std::memory_order::acquire ) )
+			{
+				magazine::bump( m.remote_refills );
+				while ( list && m.count != magazine_size )
+				{
+					m.items[ m.count++ ] = list;
+					list = list->next;
+				}
+				m.spill = list;
+				return m.items[ --m.count ];
+			}
+
+			// Allocate a batch from the colony.
+			//
+			magazine::bump( m.colony_refills );
+			std::lock_guard _g{ lock };
+			for ( size_t n = 0; n != ( magazine_size / 2 ); n++ )
+				m.items[ m.count++ ] = &*colony.emplace();
+			num_allocations += magazine_size / 2;
+			return m.items[ --m.count ];
+		}
+		NO_INLINE void flush( magazine& m )
+		{
+			// Chain the older half and push it onto the shared list.
+			//
+			magazine::bump( m.flushes );
+			constexpr size_t half = magazine_size / 2;
+			free_node* head = ( free_node* ) m.items[ 0 ];
+			for ( size_t n = 0; n != ( half - 1 ); n++ )
+				( ( free_node* ) m.items[ n ] )->next = ( free_node* ) m.items[ n + 1 ];
+			free_node* tail = ( free_node* ) m.items[ half - 1 ];
+			tail->next = returned.load( std::memory_order::relaxed );
+			while ( !returned.compare_exchange_weak( tail->next, head, std::memory_order::release, std::memory_order::relaxed ) );
+
+			std::copy( &m.items[ half ], &m.items[ m.count ], &m.items[ 0 ] );
+			m.count -= half;
+		}
+		void release( magazine* m )
+		{
+			bool was_dying;
+			{
+				std::lock_guard _g{ lock };
+				release_locked( m );
+				was_dying = dying;
+			}
+
+			// If the destructor is waiting on us, this is the last access to the pool.
+			//
+			if ( was_dying )
+				pending_releases.fetch_sub( 1, std::memory_order::release );
+		}
+		void release_locked( magazine* m )
+		{
+			for ( size_t n = 0; n != m->count; n++ )
+				colony.erase( colony.get_iterator( ( element_type* ) m->items[ n ] ) );
+			num_allocations -= m->count;
+			for ( auto* it = std::exchange( m->spill, nullptr ); it; )
+			{
+				auto* next = it->next;
+				colony.erase( colony.get_iterator( ( element_type* ) it ) );
+				num_allocations--;
+				it = next;
+			}
+			m->count = 0;
+
+			// Unregister and keep the statistics.
+			//
+			retired_stats += m->stats();
+			for ( auto** it = &magazines; *it; it = &( *it )->next_registered )
+			{
+				if ( *it == m )
+				{
+					*it = m->next_registered;
+					break;
+				}
+			}
+		}
+
+		// Returns the blocks cached by the calling thread and the shared list to the colony.
+		//
+		void trim()
+		{
+			if constexpr ( use_magazines )
+			{
+				auto& m = local_magazine();
+				auto* list = returned.exchange( nullptr, std::memory_order::acquire );
+				std::lock_guard _g{ lock };
+				auto erase = [ & ] ( void* p ) 
+				{
+					colony.erase( colony.get_iterator( ( element_type* ) p ) );
+					num_allocations--;
+				};
+				for ( size_t n = 0; n != m.count; n++ )
+					erase( m.items[ n ] );
+				m.count = 0;
+				for ( auto* lists : { list, std::exchange( m.spill, nullptr ) } )
+				{
+					while ( lists )
+					{
+						auto* next = lists->next;
+						erase( lists );
+						lists = next;
+					}
+				}
+			}
+		}
+
+		// Returns the statistics accumulated by all threads.
+		//
+		object_pool_stats stats()
+		{
+			object_pool_stats result = {};
+			if constexpr ( use_magazines )
+			{
+				std::lock_guard _g{ lock };
+				result = retired_stats;
+				for ( auto* it = magazines; it; it = it->next_registered )
+					result += it->stats();
+			}
+			return result;
+		}
 
 		// Basic interface.
 		//
 		void* allocate()
 		{
+			if constexpr ( use_magazines )
+			{
+				auto& m = local_magazine();
+				magazine::bump( m.allocations );
+				if ( m.count ) [[likely]]
+				{
+					magazine::bump( m.hits );
+					return m.items[ --m.count ];
+				}
+				if ( auto* node = m.spill )
+				{
+					magazine::bump( m.hits );
+					m.spill = node->next;
+					return node;
+				}
+				return refill( m );
+			}
 			if constexpr ( ThreadSafe ) lock.lock();
 			void* result = &*colony.emplace();
 			num_allocations++;
@@ -37,6 +327,15 @@ namespace xstd
 		}
 		void deallocate( void* pointer )
 		{
+			if constexpr ( use_magazines )
+			{
+				auto& m = local_magazine();
+				magazine::bump( m.deallocations );
+				if ( m.count == magazine_size ) [[unlikely]]
+					flush( m );
+				m.items[ m.count++ ] = pointer;
+				return;
+			}
 			if constexpr ( ThreadSafe ) lock.lock();
 			colony.erase( colony.get_iterator( ( element_type* ) pointer ) );
 			num_allocations--;
@@ -3,6 +3,7 @@
 #include <vector>
 #include <tuple>
 #include <span>
+#include <ranges>
 #include <optional>
 #include <unordered_map>
 #include "assert.hpp"
@@ -11,6 +12,23 @@
 #include "bitwise.hpp"
 #include "hashable.hpp"
 #include "narrow_cast.hpp"
+#include "vec_buffer.hpp"
+#include "cpu_dispatch.hpp"
+
+// [[Configuration]]
+// XSTD_HW_VARINT_SIMD: Determines the availability of 128-bit SIMD for bulk index encoding/decoding, 256-bit blocks
+//                      are used on AMD64 when AVX2 is either targeted or selected at runtime by XSTD_CPU_DISPATCH.
+//
+#ifndef XSTD_HW_VARINT_SIMD
+	#define XSTD_HW_VARINT_SIMD ( AMD64_TARGET || ( ARM64_TARGET && GNU_COMPILER ) )
+#endif
+#if XSTD_HW_VARINT_SIMD
+	#if AMD64_TARGET
+		#include <immintrin.h>
+	#else
+		#include "sse2neon.h"
+	#endif
+#endif
 
 namespace xstd
 {
@@ -192,6 +210,240 @@ namespace xstd
 		shrink_resize( out, pos );
 	}
 
+	// Maps integers to and from the index domain, signed integers carry the sign in the lowest bit.
+	//
+	template<Integral T>
+	FORCE_INLINE inline constexpr uint64_t to_index( T value )
+	{
+		if constexpr ( Signed<T> )
+		{
+			if ( value >= 0 ) return ( uint64_t( value )  << 1 );
+			else              return ( uint64_t( -value ) << 1 ) | 1;
+		}
+		else
+		{
+			return ( uint64_t ) value;
+		}
+	}
+	template<Integral T>
+	FORCE_INLINE inline constexpr T from_index( uint64_t value )
+	{
+		if constexpr ( Signed<T> )
+		{
+			if ( value & 1 )
+				return -T( value >> 1 );
+			else
+				return T( value >> 1 );
+		}
+		else
+		{
+			return T( value );
+		}
+	}
+
+	namespace impl
+	{
+		// Number of bytes processed per vector step, the wide block is only used under AVX2.
+		//
+		inline constexpr size_t index_block =      16;
+		inline constexpr size_t index_block_wide = 32;
+		inline constexpr size_t index_block_for( size_t simd_width )
+		{
+#if XSTD_HW_VARINT_SIMD && AMD64_TARGET && ( defined( __AVX2__ ) || XSTD_CPU_DISPATCH )
+			if ( simd_width >= index_block_wide )
+				return index_block_wide;
+#endif
+			return index_block;
+		}
+
+		// Returns the terminator mask for the Block bytes at the given pointer. Without a compile-time AVX2 target
+		// the wide mask is merged from two halves, which the dispatched clones still emit as VEX instructions.
+		//
+		template<size_t Block = index_block>
+		FORCE_INLINE inline uint32_t index_terminators( const uint8_t* in )
+		{
+#if XSTD_HW_VARINT_SIMD
+			if constexpr ( Block == index_block_wide )
+			{
+#if AMD64_TARGET && defined( __AVX2__ )
+				return ( uint32_t ) _mm256_movemask_epi8( _mm256_loadu_si256( ( const __m256i* ) in ) );
+#else
+				return index_terminators<index_block>( in ) | ( index_terminators<index_block>( in + index_block ) << index_block );
+#endif
+			}
+			else
+			{
+				return ( uint32_t ) _mm_movemask_epi8( _mm_loadu_si128( ( const __m128i* ) in ) );
+			}
+#else
+			uint32_t mask = 0;
+			for ( size_t i = 0; i != Block; i++ )
+				mask |= uint32_t( in[ i ] >> 7 ) << i;
+			return mask;
+#endif
+		}
+
+		// Block codecs behind encode_indices/decode_indices.
+		//
+		template<size_t Block, Integral T>
+		FORCE_INLINE inline size_t encode_indices( uint8_t* out, const T* values, size_t count )
+		{
+			uint8_t* it = out;
+			size_t n = 0;
+
+			// Blocks consisting of single byte indices are packed directly.
+			//
+			for ( ; ( n + Block ) <= count; n += Block )
+			{
+				uint64_t acc = 0;
+				for ( size_t i = 0; i != Block; i++ )
+					acc |= to_index( values[ n + i ] );
+				if ( acc < 0x80 )
+				{
+					for ( size_t i = 0; i != Block; i++ )
+						it[ i ] = uint8_t( to_index( values[ n + i ] ) | 0x80 );
+					it += Block;
+				}
+				else
+				{
+					for ( size_t i = 0; i != Block; i++ )
+						it += encode_index( it, to_index( values[ n + i ] ) );
+				}
+			}
+			for ( ; n != count; n++ )
+				it += encode_index( it, to_index( values[ n ] ) );
+			return it - out;
+		}
+		template<size_t Block, Integral T>
+		FORCE_INLINE inline std::optional<size_t> decode_indices( T* out, size_t count, const uint8_t* in, size_t limit )
+		{
+			size_t pos = 0, n = 0;
+			while ( n != count && ( pos + Block ) <= limit )
+			{
+				uint32_t mask = index_terminators<Block>( in + pos );
+
+				// Block of single byte indices, expand directly.
+				//
+				if ( mask == uint32_t( fill_bits( Block ) ) && ( n + Block ) <= count )
+				{
+					for ( size_t i = 0; i != Block; i++ )
+						out[ n + i ] = from_index<T>( in[ pos + i ] & 0x7F );
+					n += Block;
+					pos += Block;
+					continue;
+				}
+
+				// No terminators within the maximum length, invalid.
+				//
+				if ( !( mask & fill_bits( max_index_length ) ) ) [[unlikely]]
+					return std::nullopt;
+
+				// Walk the terminators within the block.
+				//
+				while ( mask && n != count )
+				{
+					size_t len = size_t( lsb( mask ) ) + 1;
+					if ( len > max_index_length ) [[unlikely]]
+						return std::nullopt;
+					uint64_t value;
+					if ( len <= 8 && ( pos + 8 ) <= limit ) [[likely]]
+					{
+						uint64_t e1 = trivial_read_n<uint64_t, 8>( in + pos );
+#if XSTD_HW_PDEP_PEXT
+						value = bit_pext<uint64_t>( e1, 0x7f7f7f7f7f7f7f7f );
+#else
+						value = 0;
+						for ( size_t i = 0; i != 8; i++ )
+							value |= ( ( e1 >> ( i * 8 ) ) & 0x7F ) << ( i * 7 );
+#endif
+						value &= fill_bits( len * 7 );
+					}
+					else
+					{
+						value = decode_index( in + pos, limit - pos ).first;
+					}
+					out[ n++ ] = from_index<T>( value );
+					pos += len;
+					mask >>= len;
+				}
+			}
+
+			// Handle the tail.
+			//
+			for ( ; n != count; n++ )
+			{
+				auto [value, len] = decode_index( in + pos, limit - pos );
+				if ( len < 0 || size_t( len ) > ( limit - pos ) ) [[unlikely]]
+					return std::nullopt;
+				out[ n ] = from_index<T>( value );
+				pos += len;
+			}
+			return pos;
+		}
+	};
+
+	// Encodes the given integers in index format into the buffer, caller must have
+	// count * max_index_length bytes reserved as the output.
+	//  - Returns the actual length.
+	//
+	template<Integral T>
+	inline size_t encode_indices( uint8_t* out, const T* values, size_t count )
+	{
+		return simd_dispatch( [ & ] <auto W> ( const_tag<W> ) FORCE_INLINE {
+			return impl::encode_indices<impl::index_block_for( W )>( out, values, count );
+		}, count >= impl::index_block_wide );
+	}
+
+	// Decodes [count] integers in index format from the buffer.
+	// - Returns the number of bytes consumed, std::nullopt indicates error.
+	//
+	template<Integral T>
+	inline std::optional<size_t> decode_indices( T* out, size_t count, const uint8_t* in, size_t limit )
+	{
+		return simd_dispatch( [ & ] <auto W> ( const_tag<W> ) FORCE_INLINE {
+			return impl::decode_indices<impl::index_block_for( W )>( out, count, in, limit );
+		}, limit >= impl::index_block_wide );
+	}
+
+	// Skips [count] indices in the buffer.
+	// - Returns the number of bytes consumed, std::nullopt indicates error.
+	//
+	inline std::optional<size_t> skip_indices( size_t count, const uint8_t* in, size_t limit )
+	{
+		size_t pos = 0;
+		while ( count && ( pos + impl::index_block ) <= limit )
+		{
+			uint32_t mask = impl::index_terminators( in + pos );
+			size_t num = popcnt( mask );
+			if ( num <= count )
+			{
+				// Consume the whole block, anything after the last terminator is resumed next step.
+				//
+				if ( !num ) [[unlikely]]
+					return std::nullopt;
+				count -= num;
+				pos += size_t( msb( mask ) ) + 1;
+			}
+			else
+			{
+				// Drop the terminators we need and stop at the last one.
+				//
+				for ( size_t i = 1; i != count; i++ )
+					mask &= mask - 1;
+				pos += size_t( lsb( mask ) ) + 1;
+				count = 0;
+			}
+		}
+		for ( ; count; count-- )
+		{
+			auto [value, len] = decode_index( in + pos, limit - pos );
+			if ( len < 0 || size_t( len ) > ( limit - pos ) ) [[unlikely]]
+				return std::nullopt;
+			pos += len;
+		}
+		return pos;
+	}
+
 	// Declare serialization interface.
 	//
 	struct serialization;
@@ -214,7 +466,6 @@ namespace xstd
 	{
 		struct pointer_record {
 			size_t index = 0;
-			std::vector<uint8_t> output_stream = {};
 			bool is_backed = false; // Not serialized, temporary.
 		};
 
@@ -229,14 +480,20 @@ namespace xstd
 		int64_t version = 0;
 
 		// Fields used during serialization.
+		// - Pointee streams are appended to the pointer table as soon as they are complete,
+		//   scratch streams are recycled so that steady state writes do not allocate.
 		//
-		std::vector<uint8_t> output_stream;
+		vec_buffer output_stream;
+		size_t output_base = 0;
+		vec_buffer pointer_table;
+		std::vector<vec_buffer> scratch_streams;
 		std::optional<std::unordered_map<any_ptr, pointer_record, xstd::hasher<>>> pointers;
 
 		// Fields used during deserialization.
 		//
 		const uint8_t* input_start = nullptr;
 		std::span<const uint8_t> input_stream;
+		std::vector<uint8_t> input_storage;
 		std::optional<std::unordered_map<size_t, rpointer_record, xstd::hasher<>>> rpointers;
 
 		// Constructed from an optional byte array.
@@ -244,8 +501,19 @@ namespace xstd
 		serialization() {}
 		serialization( std::span<const uint8_t> view, bool no_header = false ) { load( view.data(), view.size(), no_header ); }
 		serialization( const std::vector<uint8_t>& container, bool no_header = false ) { load( container.data(), container.size(), no_header ); }
-		serialization( std::vector<uint8_t>&& container, bool no_header = false ) : output_stream( std::move( container ) ) { load( output_stream, no_header ); }
+		serialization( std::vector<uint8_t>&& container, bool no_header = false ) : input_storage( std::move( container ) ) { load( input_storage.data(), input_storage.size(), no_header ); }
 		serialization( const void* data, size_t length, bool no_header = false ) { load( data, length, no_header ); }
+
+		// Creates a writer appending into the given buffer, existing contents are preserved and the
+		// result is written after them, capacity is reused.
+		//
+		static serialization writer( vec_buffer&& into )
+		{
+			serialization ctx = {};
+			ctx.output_base = into.size();
+			ctx.output_stream = std::move( into );
+			return ctx;
+		}
 		
 		// Default move, no copy.
 		//
@@ -256,9 +524,11 @@ namespace xstd
 		//
 		std::vector<uint8_t> dump( bool no_header = false ) const;
 		std::vector<uint8_t> dump( bool no_header = false );
+		vec_buffer& dump( vec_buffer& out, bool no_header = false ) const;
+		vec_buffer dump_buffer( bool no_header = false );
 		serialization& load( std::span<const uint8_t> view, bool no_header = false ) { return load( view.data(), view.size(), no_header ); }
 		serialization& load( const std::vector<uint8_t>& container, bool no_header = false ) { return load( container.data(), container.size(), no_header ); }
-		serialization& load( std::vector<uint8_t>&& container, bool no_header = false ) { output_stream = std::move( container ); return load( output_stream, no_header ); }
+		serialization& load( std::vector<uint8_t>&& container, bool no_header = false ) { input_storage = std::move( container ); return load( input_storage.data(), input_storage.size(), no_header ); }
 		serialization& load( const void* data, size_t length, bool no_header = false );
 
 		// Raw data read write.
@@ -280,7 +550,7 @@ namespace xstd
 		}
 		serialization& write( const void* src, size_t length )
 		{
-			output_stream.insert( output_stream.end(), ( const uint8_t* ) src, ( const uint8_t* ) src + length );
+			output_stream.append_range( std::span{ ( const uint8_t* ) src, length } );
 			return *this;
 		}
 
@@ -298,6 +568,40 @@ namespace xstd
 			throw_fmt( XSTD_ESTR( "Invalid index value." ) );
 		}
 
+		// Bulk index read/write.
+		//
+		template<Integral T>
+		void write_indices( const T* values, size_t count )
+		{
+			constexpr size_t chunk = 1024;
+			while ( count )
+			{
+				size_t n = std::min( count, chunk );
+				size_t pos = output_stream.size();
+				uint8_t* out = output_stream.push( n * max_index_length );
+				output_stream.shrink_resize( pos + encode_indices( out, values, n ) );
+				values += n;
+				count -= n;
+			}
+		}
+		template<Integral T>
+		void read_indices( T* out, size_t count )
+		{
+			if ( auto len = decode_indices( out, count, input_stream.data(), input_stream.size() ) ) [[likely]] {
+				input_stream = input_stream.subspan( *len );
+				return;
+			}
+			throw_fmt( XSTD_ESTR( "Invalid index value." ) );
+		}
+		void skip_idx( size_t count )
+		{
+			if ( auto len = skip_indices( count, input_stream.data(), input_stream.size() ) ) [[likely]] {
+				input_stream = input_stream.subspan( *len );
+				return;
+			}
+			throw_fmt( XSTD_ESTR( "Invalid index value." ) );
+		}
+
 		// Provide templated member helper for convenience.
 		//
 		template<typename T> T read();
@@ -316,10 +620,29 @@ namespace xstd
 			rec.is_backed |= owning;
 			if ( !rec.index )
 			{
-				rec.index = pointers->size();
-				rec.output_stream = std::exchange( output_stream, {} );
+				size_t index = rec.index = pointers->size();
+
+				// Serialize into a recycled scratch stream.
+				//
+				vec_buffer stream = {};
+				if ( !scratch_streams.empty() )
+				{
+					stream = std::move( scratch_streams.back() );
+					scratch_streams.pop_back();
+				}
+				std::swap( stream, output_stream );
+				size_t base = std::exchange( output_base, 0 );
 				serialize( *this, *value );
-				std::swap( rec.output_stream, output_stream );
+				std::swap( stream, output_stream );
+				output_base = base;
+
+				// Append the entry to the pointer table and return the stream to the cache.
+				//
+				encode_index( pointer_table, index );
+				encode_index( pointer_table, stream.size() );
+				pointer_table.append_range( stream.subspan() );
+				stream.clear();
+				scratch_streams.emplace_back( std::move( stream ) );
 			}
 			write_idx( rec.index );
 		}
@@ -328,6 +651,8 @@ namespace xstd
 		{
 			size_t index = read_idx();
 			if ( !index ) return nullptr;
+			if ( !rpointers )
+				throw_fmt( XSTD_ESTR( "Referencing pointer table without headers." ) );
 
 			auto& rec = rpointers->at( index );
 			if ( !rec.is_lifted )
@@ -346,6 +671,8 @@ namespace xstd
 		{
 			size_t index = read_idx();
 			if ( !index ) return nullptr;
+			if ( !rpointers )
+				throw_fmt( XSTD_ESTR( "Referencing pointer table without headers." ) );
 
 			auto& rec = rpointers->at( index );
 			if ( !rec.is_lifted )
@@ -364,36 +691,53 @@ namespace xstd
 		//
 		bool is_input() const { return !input_stream.empty(); }
 		bool empty() const { return !length(); }
-		size_t length() const { return is_input() ? input_stream.size() : output_stream.size(); }
-		size_t offset() const { return is_input() ? input_stream.data() - input_start : output_stream.size(); }
+		size_t length() const { return is_input() ? input_stream.size() : output_stream.size() - output_base; }
+		size_t offset() const { return is_input() ? input_stream.data() - input_start : output_stream.size() - output_base; }
 
 		// Reads or writes the headers.
 		//
-		std::vector<uint8_t> write_header() const
+		size_t header_prefix( uint8_t* out ) const
 		{
-			serialization sx = {};
-
 			// If version bumps are used or if the first pointer's index clashes with our magic number, write the version header.
 			//
-			if ( version || ( pointers && !pointers->empty() && ( pointers->begin()->second.index & 0xFF ) == 0xCA ) ) {
-				sx.write_idx( 0xca | ( uint64_t( version ) << 8 ) );
+			if ( !version && !pointer_table.empty() ) {
+				if ( ( decode_index( pointer_table.data(), pointer_table.size() ).first & 0xFF ) != 0xCA )
+					return 0;
+			} else if ( !version ) {
+				return 0;
 			}
-
-			// Write pointers.
-			//
+			return encode_index( out, 0xca | ( uint64_t( version ) << 8 ) );
+		}
+		void validate_pointers() const
+		{
 			if ( pointers ) {
 				for ( auto& [ptr, rec] : *pointers ) {
 					if ( !rec.is_backed )
 						throw_fmt( XSTD_ESTR( "Dangling pointer serialized!" ) );
 					if ( !rec.index )
 						throw_fmt( XSTD_ESTR( "Invalid pointer table." ) );
-					sx.write_idx( rec.index );
-					sx.write_idx( rec.output_stream.size() );
-					sx.write( rec.output_stream.data(), rec.output_stream.size() );
 				}
 			}
-			sx.write_idx( 0 );
-			return std::move( sx.output_stream );
+		}
+		template<typename F>
+		void write_header( F&& emit ) const
+		{
+			validate_pointers();
+			uint8_t prefix[ max_index_length + 1 ];
+			size_t prefix_length = header_prefix( prefix );
+			emit( std::span<const uint8_t>{ prefix, prefix_length }, pointer_table.subspan() );
+		}
+		std::vector<uint8_t> write_header() const
+		{
+			std::vector<uint8_t> result;
+			write_header( [ & ] ( std::span<const uint8_t> prefix, std::span<const uint8_t> table )
+			{
+				result.reserve( prefix.size() + table.size() + 1 );
+				result.insert( result.end(), prefix.begin(), prefix.end() );
+				result.insert( result.end(), table.begin(), table.end() );
+				result.push_back( 0x80 );
+			} );
+			return result;
 		}
 		serialization& read_header()
 		{
@@ -426,7 +770,7 @@ namespace xstd
 
 	// Implement it for trivials, atomics, iterables, tuples, variants, hash type and optionals.
 	//
-	template<TrivialForSerialization T> requires ( DefaultSerialized<T> && !Integral<T> )
+	template<TrivialForSerialization T> requires ( DefaultSerialized<T> && !Integral<T> && !Optional<T> )
 	struct serializer<T>
 	{
 		static void apply( serialization& ctx, const T& value )
@@ -439,6 +783,10 @@ namespace xstd
 			ctx.read( &value, sizeof( T ) );
 			return value;
 		}
+		static void skip( serialization& ctx )
+		{
+			ctx.skip( sizeof( T ) );
+		}
 	};
 	template<Integral T>
 	struct serializer<T>
@@ -451,17 +799,7 @@ namespace xstd
 			}
 			else
 			{
-				size_t pvalue;
-				if constexpr ( Signed<T> )
-				{
-					if ( value >= 0 ) pvalue = ( size_t( value )  << 1 );
-					else              pvalue = ( size_t( -value ) << 1 ) | 1;
-				}
-				else
-				{
-					pvalue = ( size_t ) value;
-				}
-				ctx.write_idx( pvalue );
+				ctx.write_idx( to_index( value ) );
 			}
 		}
 		static T reflect( serialization& ctx )
@@ -474,20 +812,16 @@ namespace xstd
 			}
 			else
 			{
-				size_t pvalue = ctx.read_idx();
-				if constexpr ( Signed<T> )
-				{
-					if ( pvalue & 1 )
-						return -( std::remove_const_t<T> )( pvalue >> 1 );
-					else
-						return ( std::remove_const_t<T> )( pvalue >> 1 );
-				}
-				else
-				{
-					return ( std::remove_const_t<T> ) pvalue;
-				}
+				return from_index<std::remove_const_t<T>>( ctx.read_idx() );
 			}
 		}
+		static void skip( serialization& ctx )
+		{
+			if constexpr ( sizeof( T ) == 1 )
+				ctx.skip( 1 );
+			else
+				ctx.read_idx();
+		}
 	};
 	template<Atomic T>
 	struct serializer<T>
@@ -504,11 +838,33 @@ namespace xstd
 	template<Iterable T> requires ( DefaultSerialized<T> && !TrivialForSerialization<T> && !StdArray<T> )
 	struct serializer<T>
 	{
+		using V = iterable_val_t<T>;
+		static constexpr bool is_index_array = Integral<V> && sizeof( V ) != 1;
+
 		static void apply( serialization& ctx, const T& value )
 		{
 			ctx.write_idx( std::size( value ) );
-			for ( auto& entry : value )
-				serialize( ctx, entry );
+			if constexpr ( is_index_array && std::ranges::contiguous_range<const T&> )
+			{
+				ctx.write_indices( std::ranges::data( value ), std::size( value ) );
+			}
+			else if constexpr ( is_index_array )
+			{
+				std::remove_const_t<V> buffer[ 256 ];
+				size_t n = 0;
+				for ( auto& entry : value )
+				{
+					buffer[ n++ ] = entry;
+					if ( n == std::size( buffer ) )
+						ctx.write_indices( buffer, std::exchange( n, 0 ) );
+				}
+				ctx.write_indices( buffer, n );
+			}
+			else
+			{
+				for ( auto& entry : value )
+					serialize( ctx, entry );
+			}
 		}
 		static T reflect( serialization& ctx )
 		{
@@ -517,15 +873,36 @@ namespace xstd
 				throw_fmt( XSTD_ESTR( "Referencing out of stream boundaries." ) );
 
 			std::vector<iterable_val_t<T>> entries;
-			entries.reserve( cnt );
-			for ( size_t n = 0; n != cnt; n++ )
-				entries.emplace_back( deserialize<iterable_val_t<T>>( ctx ) );
+			if constexpr ( is_index_array )
+			{
+				uninitialized_resize( entries, cnt );
+				ctx.read_indices( entries.data(), cnt );
+			}
+			else
+			{
+				entries.reserve( cnt );
+				for ( size_t n = 0; n != cnt; n++ )
+					entries.emplace_back( deserialize<iterable_val_t<T>>( ctx ) );
+			}
 	
 			if constexpr ( Same<T, std::vector<iterable_val_t<T>>> )
 				return entries;
 			else
 				return T{ std::make_move_iterator( entries.begin() ), std::make_move_iterator( entries.end() ) };
 		}
+		static void skip( serialization& ctx )
+		{
+			size_t cnt = ctx.read_idx();
+			if constexpr ( is_index_array )
+			{
+				ctx.skip_idx( cnt );
+			}
+			else
+			{
+				for ( size_t n = 0; n != cnt; n++ )
+					skip_serialized<iterable_val_t<T>>( ctx );
+			}
+		}
 	};
 	template<Tuple T>
 	struct serializer<T>
@@ -560,6 +937,16 @@ namespace xstd
 				}
 			}
 		}
+		static void skip( serialization& ctx )
+		{
+			if constexpr ( std::tuple_size_v<T> != 0 )
+			{
+				make_constant_series<std::tuple_size_v<T>>( [ & ] <auto N> ( const_tag<N> )
+				{
+					skip_serialized<std::tuple_element_t<N, T>>( ctx );
+				} );
+			}
+		}
 	};
 	template<Variant T>
 	struct serializer<T>
@@ -595,7 +982,7 @@ namespace xstd
 			if ( value.has_value() )
 			{
 				ctx.write<int8_t>( 1 );
-				ctx.write<T>( value.value() );
+				ctx.write<typename T::value_type>( value.value() );
 			}
 			else
 			{
@@ -609,6 +996,11 @@ namespace xstd
 			else
 				return std::nullopt;
 		}
+		static void skip( serialization& ctx )
+		{
+			if ( ctx.read<int8_t>() )
+				skip_serialized<typename T::value_type>( ctx );
+		}
 	};
 	template<>
 	struct serializer<hash_t>
@@ -623,6 +1015,10 @@ namespace xstd
 			ctx.read( &value, sizeof( value ) );
 			return value;
 		}
+		static void skip( serialization& ctx )
+		{
+			ctx.skip( sizeof( hash_t ) );
+		}
 	};
 
 	// Acceleration for std::basic_string, std::vector<trivial>, std::array<trivial>.
@@ -646,6 +1042,13 @@ namespace xstd
 			ctx.read( result.data(), cnt * sizeof( T ) );
 			return result;
 		}
+		static void skip( serialization& ctx )
+		{
+			size_t cnt = ctx.read_idx();
+			if ( cnt > ( ctx.input_stream.size() / sizeof( T ) ) )
+				throw_fmt( XSTD_ESTR( "Referencing out of stream boundaries." ) );
+			ctx.skip( cnt * sizeof( T ) );
+		}
 	};
 	template<typename T, size_t N>
 	struct serializer<std::array<T, N>>
@@ -678,6 +1081,18 @@ namespace xstd
 			}
 			return std::move( result );
 		}
+		static void skip( serialization& ctx )
+		{
+			if constexpr ( TrivialForSerialization<T> && !Pointer<T> )
+			{
+				ctx.skip( N * sizeof( T ) );
+			}
+			else
+			{
+				for ( size_t i = 0; i != N; i++ )
+					skip_serialized<T>( ctx );
+			}
+		}
 	};
 	template<typename T>
 	struct serializer<std::basic_string<T>>
@@ -698,6 +1113,58 @@ namespace xstd
 			ctx.read( result.data(), cnt * sizeof( T ) );
 			return result;
 		}
+		static void skip( serialization& ctx )
+		{
+			serializer<std::vector<T>>::skip( ctx );
+		}
+	};
+
+	// Zero-copy views over std::vector<trivial> and std::basic_string, the result references
+	// the input stream and is only valid for as long as the deserialized buffer is. The stream
+	// gives no alignment guarantees, so only byte-aligned elements can be viewed, wider types can
+	// still be written as views but must be read back as owning containers or a serialized_view.
+	//
+	template<TrivialForSerialization T> requires ( !Pointer<T> )
+	struct serializer<std::span<const T>>
+	{
+		static void apply( serialization& ctx, std::span<const T> value )
+		{
+			ctx.write_idx( value.size() );
+			ctx.write( value.data(), value.size() * sizeof( T ) );
+		}
+		static std::span<const T> reflect( serialization& ctx )
+		{
+			static_assert( alignof( T ) == 1, "Zero-copy views require byte-aligned elements, deserialize as an owning container instead." );
+			size_t cnt = ctx.read_idx();
+			if ( cnt > ( ctx.input_stream.size() / sizeof( T ) ) )
+				throw_fmt( XSTD_ESTR( "Referencing out of stream boundaries." ) );
+
+			auto* data = ( const T* ) ctx.input_stream.data();
+			ctx.skip( cnt * sizeof( T ) );
+			return { data, cnt };
+		}
+		static void skip( serialization& ctx )
+		{
+			serializer<std::vector<T>>::skip( ctx );
+		}
+	};
+	template<typename T>
+	struct serializer<std::basic_string_view<T>>
+	{
+		static void apply( serialization& ctx, std::basic_string_view<T> value )
+		{
+			ctx.write_idx( value.size() );
+			ctx.write( value.data(), value.size() * sizeof( T ) );
+		}
+		static std::basic_string_view<T> reflect( serialization& ctx )
+		{
+			auto view = serializer<std::span<const T>>::reflect( ctx );
+			return { view.data(), view.size() };
+		}
+		static void skip( serialization& ctx )
+		{
+			serializer<std::vector<T>>::skip( ctx );
+		}
 	};
 
 	// Implement it for pointer types the type is final.
@@ -827,9 +1294,191 @@ namespace xstd
 	{
 		static void apply( serialization&, const std::monostate& ) {}
 		static std::monostate reflect( serialization& ) { return {}; }
+		static void skip( serialization& ) {}
 	};
 	template<typename T>
 	using serializer_t = serializer<std::remove_cvref_t<T>>;
+
+	// Skips over a serialized value, decoding it only if the serializer does not know how to skip.
+	//
+	template<typename T>
+	static void skip_serialized( serialization& ctx )
+	{
+		if constexpr ( requires { serializer_t<T>::skip( ctx ); } )
+			serializer_t<T>::skip( ctx );
+		else
+			( void ) serializer_t<T>::reflect( ctx );
+	}
+
+	// Lazy view of a serialized container, elements are decoded on iteration straight out of the
+	// input stream. Elements must not reference the pointer table.
+	//
+	template<Iterable C> requires ( !StdArray<C> )
+	struct serialized_view
+	{
+		using value_type = iterable_val_t<C>;
+
+		// Whether or not the container is serialized as a raw array of elements.
+		//
+		static constexpr bool is_raw = TrivialForSerialization<value_type> && !Pointer<value_type> &&
+			( Same<C, std::vector<value_type>> || Same<C, std::basic_string<value_type>> );
+
+		std::span<const uint8_t> range = {};
+		size_t count = 0;
+		int64_t version = 0;
+
+		static value_type read_raw( const uint8_t* src )
+		{
+			std::remove_const_t<value_type> value;
+			memcpy( &value, src, sizeof( value_type ) );
+			return value;
+		}
+
+		struct iterator
+		{
+			using iterator_category = std::input_iterator_tag;
+			using difference_type =   ptrdiff_t;
+			using value_type =        typename serialized_view::value_type;
+			using reference =         value_type;
+			using pointer =           void;
+
+			const uint8_t* pos = nullptr;
+			const uint8_t* limit = nullptr;
+			size_t left = 0;
+			int64_t version = 0;
+			mutable const uint8_t* next = nullptr;
+
+			serialization context() const
+			{
+				serialization ctx = {};
+				ctx.input_start = pos;
+				ctx.input_stream = { pos, limit };
+				ctx.version = version;
+				return ctx;
+			}
+
+			value_type operator*() const
+			{
+				if constexpr ( is_raw )
+				{
+					return read_raw( pos );
+				}
+				else
+				{
+					auto ctx = context();
+					auto value = deserialize<value_type>( ctx );
+					next = ctx.input_stream.data();
+					return value;
+				}
+			}
+			iterator& operator++()
+			{
+				if constexpr ( is_raw )
+				{
+					pos += sizeof( value_type );
+				}
+				else
+				{
+					if ( !next )
+					{
+						auto ctx = context();
+						skip_serialized<value_type>( ctx );
+						next = ctx.input_stream.data();
+					}
+					pos = std::exchange( next, nullptr );
+				}
+				--left;
+				return *this;
+			}
+			iterator operator++( int ) { auto s = *this; ++*this; return s; }
+			bool operator==( const iterator& o ) const { return left == o.left; }
+			bool operator!=( const iterator& o ) const { return left != o.left; }
+		};
+
+		// Container interface.
+		//
+		iterator begin() const { return { range.data(), range.data() + range.size(), count, version }; }
+		iterator end() const { return {}; }
+		size_t size() const { return count; }
+		bool empty() const { return !count; }
+		value_type at( size_t n ) const
+		{
+			if ( n >= count )
+				throw_fmt( XSTD_ESTR( "Serialized view index out of range." ) );
+			if constexpr ( is_raw )
+				return read_raw( range.data() + n * sizeof( value_type ) );
+			else
+				return *std::next( begin(), n );
+		}
+		value_type operator[]( size_t n ) const { return at( n ); }
+
+		// Decodes the whole container.
+		//
+		C materialize() const
+		{
+			if constexpr ( is_raw )
+			{
+				C result = {};
+				uninitialized_resize( result, count );
+				memcpy( result.data(), range.data(), count * sizeof( value_type ) );
+				return result;
+			}
+			else
+			{
+				C result = {};
+				if constexpr ( requires { result.reserve( count ); } )
+					result.reserve( count );
+				for ( auto&& value : *this )
+					result.insert( result.end(), std::move( value ) );
+				return result;
+			}
+		}
+	};
+	template<typename C>
+	struct serializer<serialized_view<C>>
+	{
+		static void apply( serialization& ctx, const serialized_view<C>& value )
+		{
+			ctx.write_idx( value.count );
+			ctx.write( value.range.data(), value.range.size() );
+		}
+		static serialized_view<C> reflect( serialization& ctx )
+		{
+			serialized_view<C> result = {};
+			result.count = ctx.read_idx();
+			result.version = ctx.version;
+
+			const uint8_t* begin = ctx.input_stream.data();
+			if constexpr ( serialized_view<C>::is_raw )
+			{
+				using T = typename serialized_view<C>::value_type;
+				if ( result.count > ( ctx.input_stream.size() / sizeof( T ) ) )
+					throw_fmt( XSTD_ESTR( "Referencing out of stream boundaries." ) );
+				ctx.skip( result.count * sizeof( T ) );
+			}
+			else
+			{
+				using T = typename serialized_view<C>::value_type;
+				if ( result.count > ctx.input_stream.size() )
+					throw_fmt( XSTD_ESTR( "Referencing out of stream boundaries." ) );
+				if constexpr ( Integral<T> && sizeof( T ) != 1 )
+				{
+					ctx.skip_idx( result.count );
+				}
+				else
+				{
+					for ( size_t n = 0; n != result.count; n++ )
+						skip_serialized<T>( ctx );
+				}
+			}
+			result.range = { begin, ctx.input_stream.data() };
+			return result;
+		}
+		static void skip( serialization& ctx )
+		{
+			( void ) reflect( ctx );
+		}
+	};
 	
 	// Implement the simple interface.
 	//
@@ -848,32 +1497,74 @@ namespace xstd
 	
 	// Implement the final steps.
 	//
+	inline vec_buffer& serialization::dump( vec_buffer& out, bool no_header ) const
+	{
+		// Insert pointer table if headers requested, else make sure there are none.
+		//
+		auto body = output_stream.subspan( output_base );
+		if ( !no_header )
+		{
+			write_header( [ & ] ( std::span<const uint8_t> prefix, std::span<const uint8_t> table )
+			{
+				out.reserve( out.size() + prefix.size() + table.size() + 1 + body.size() );
+				out.append_range( prefix );
+				out.append_range( table );
+				out.push_back( 0x80 );
+			} );
+		}
+		else
+		{
+			if ( pointers && !pointers->empty() )
+				throw_fmt( XSTD_ESTR( "Writing a serialization with a pointer table without headers." ) );
+		}
+		out.append_range( body );
+		return out;
+	}
 	inline std::vector<uint8_t> serialization::dump( bool no_header ) const
 	{
-		auto result = output_stream;
-
 		// Insert pointer table if headers requested, else make sure there are none.
 		//
+		auto body = output_stream.subspan( output_base );
+		std::vector<uint8_t> result;
 		if ( !no_header )
 		{
-			auto ptr_tbl = write_header();
-			result.insert( output_stream.begin(), ptr_tbl.begin(), ptr_tbl.end() );
+			write_header( [ & ] ( std::span<const uint8_t> prefix, std::span<const uint8_t> table )
+			{
+				uninitialized_resize( result, prefix.size() + table.size() + 1 + body.size() );
+				uint8_t* it = result.data();
+				it = std::copy( prefix.begin(), prefix.end(), it );
+				it = std::copy( table.begin(), table.end(), it );
+				*it++ = 0x80;
+				std::copy( body.begin(), body.end(), it );
+			} );
 		}
 		else
 		{
 			if ( pointers && !pointers->empty() )
 				throw_fmt( XSTD_ESTR( "Writing a serialization with a pointer table without headers." ) );
+			result.assign( body.begin(), body.end() );
 		}
 		return result;
 	}
 	inline std::vector<uint8_t> serialization::dump( bool no_header )
 	{
-		// Insert pointer table if headers requested, else make sure there are none.
+		if ( no_header && version )
+			throw_fmt( XSTD_ESTR( "Writing versioned serialization without headers." ) );
+		return std::as_const( *this ).dump( no_header );
+	}
+	inline vec_buffer serialization::dump_buffer( bool no_header )
+	{
+		// Insert pointer table in-place if headers requested, else make sure there are none.
 		//
 		if ( !no_header )
 		{
-			auto ptr_tbl = write_header();
-			output_stream.insert( output_stream.begin(), ptr_tbl.begin(), ptr_tbl.end() );
+			write_header( [ & ] ( std::span<const uint8_t> prefix, std::span<const uint8_t> table )
+			{
+				uint8_t* it = output_stream.reserve_range( output_stream.data() + output_base, prefix.size() + table.size() + 1 );
+				it = std::copy( prefix.begin(), prefix.end(), it );
+				it = std::copy( table.begin(), table.end(), it );
+				*it = 0x80;
+			} );
 		}
 		else
 		{
@@ -882,6 +1573,9 @@ namespace xstd
 			if ( version )
 				throw_fmt( XSTD_ESTR( "Writing versioned serialization without headers." ) );
 		}
+		output_base = 0;
+		pointers.reset();
+		pointer_table.clear();
 		return std::move( output_stream );
 	}
 	inline serialization& serialization::load( const void* data, size_t length, bool no_header )
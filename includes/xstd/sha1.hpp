@@ -4,9 +4,13 @@
 #include <functional>
 #include <numeric>
 #include <cstring>
+#include <span>
+#include <vector>
 #include "intrinsics.hpp"
 #include "type_helpers.hpp"
+#include "assert.hpp"
 #include "hexdump.hpp"
+#include "cpu_dispatch.hpp"
 
 // [[Configuration]]
 // XSTD_HW_SHA1: Determines the availability of hardware SHA1.
@@ -15,6 +19,22 @@
 	#define XSTD_HW_SHA1 ( AMD64_TARGET && GNU_COMPILER )
 #endif
 
+// [[Configuration]]
+// XSTD_SHA_LANES: Number of messages hash_many interleaves across SIMD lanes when the SHA extensions are not available,
+//                 raised to the width of the host at runtime if XSTD_CPU_DISPATCH is enabled.
+//
+#ifndef XSTD_SHA_LANES
+	#if !XSTD_VECTOR_EXT
+		#define XSTD_SHA_LANES 1
+	#elif AMD64_TARGET && __AVX512F__
+		#define XSTD_SHA_LANES 16
+	#elif AMD64_TARGET && __AVX2__
+		#define XSTD_SHA_LANES 8
+	#else
+		#define XSTD_SHA_LANES 4
+	#endif
+#endif
+
 // Intel implementation.
 //
 #if XSTD_HW_SHA1 && AMD64_TARGET && GNU_COMPILER
@@ -197,6 +217,148 @@ namespace xstd
 			return clone.digest();
 		}
 
+		// Writes the padded tail of a message of the given length into the buffer, returns the number of blocks.
+		//
+		static size_t pad_tail( block_type* out, const uint8_t* data, size_t total_length )
+		{
+			size_t n = total_length % block_size;
+			size_t count = ( n + 1 ) > ( block_size - 8 ) ? 2 : 1;
+			memset( out, 0, count * block_size );
+			if ( n ) memcpy( out, data, n );
+			( ( uint8_t* ) out )[ n ] = 0x80;
+			*( uint64_t* ) &out[ count - 1 ][ block_size - 8 ] = bswapq( total_length * 8 );
+			return count;
+		}
+
+		// Lane scheduler for hash_many, each lane streams the blocks of one message and picks up the next
+		// pending message as soon as it is done, idle lanes compress a dummy block.
+		//
+		template<size_t N>
+		FORCE_INLINE static void hash_lanes( std::span<const std::span<const uint8_t>> messages, std::span<value_type> out )
+		{
+			static constexpr block_type dummy_block = { 0 };
+			struct lane_state
+			{
+				size_t         index = std::string::npos;
+				const uint8_t* data =  nullptr;
+				size_t         full_blocks = 0;
+				size_t         tail_blocks = 0;
+				size_t         tail_index =  0;
+				block_type     tail[ 2 ];
+
+				FORCE_INLINE const uint8_t* next()
+				{
+					if ( full_blocks ) {
+						full_blocks--;
+						return std::exchange( data, data + block_size );
+					}
+					tail_blocks--;
+					return tail[ tail_index++ ].data();
+				}
+				FORCE_INLINE bool done() const { return !full_blocks && !tail_blocks; }
+			};
+
+			std::array<value_type, N>     iv;
+			std::array<const uint8_t*, N> blocks;
+			std::array<lane_state, N>     lanes;
+			size_t pending = 0;
+			size_t active =  0;
+
+			auto assign = [ & ] ( size_t l )
+			{
+				auto& lane = lanes[ l ];
+				if ( pending == messages.size() ) {
+					lane.index = std::string::npos;
+					return false;
+				}
+				auto msg = messages[ pending ];
+				lane.index =       pending++;
+				lane.data =        msg.data();
+				lane.full_blocks = msg.size() / block_size;
+				lane.tail_blocks = pad_tail( lane.tail, msg.data() + lane.full_blocks * block_size, msg.size() );
+				lane.tail_index =  0;
+				iv[ l ] =          Traits::default_iv;
+				return true;
+			};
+			auto retire = [ & ] ( size_t l )
+			{
+				for ( auto& v : iv[ l ] )
+					v = bswap( v );
+				out[ lanes[ l ].index ] = iv[ l ];
+			};
+			for ( size_t l = 0; l != N; l++ )
+				active += assign( l );
+
+			while ( active )
+			{
+				// If a single message is left, finish it on the single stream path.
+				//
+				if ( active == 1 && pending == messages.size() )
+				{
+					for ( size_t l = 0; l != N; l++ )
+					{
+						if ( lanes[ l ].index != std::string::npos )
+						{
+							while ( !lanes[ l ].done() )
+								Traits::compress( iv[ l ], lanes[ l ].next() );
+							retire( l );
+						}
+					}
+					break;
+				}
+
+				for ( size_t l = 0; l != N; l++ )
+					blocks[ l ] = lanes[ l ].index != std::string::npos ? lanes[ l ].next() : dummy_block.data();
+				Traits::template compress_lanes<N>( iv, blocks );
+
+				for ( size_t l = 0; l != N; l++ )
+				{
+					if ( lanes[ l ].index != std::string::npos && lanes[ l ].done() )
+					{
+						retire( l );
+						if ( !assign( l ) )
+							active--;
+					}
+				}
+			}
+		}
+
+		// Hashes a batch of independent messages, interleaving their blocks across the lanes the traits
+		// provide. Each result is identical to the digest() of the message hashed on its own.
+		//
+		static void hash_many( std::span<const std::span<const uint8_t>> messages, std::span<value_type> out )
+		{
+			dassert( out.size() >= messages.size() );
+			if constexpr ( requires { Traits::batch_lanes(); } )
+			{
+				if ( messages.size() > 1 )
+				{
+					size_t lanes = Traits::batch_lanes();
+					if ( lanes == 2 )
+						return hash_lanes<2>( messages, out );
+					if ( lanes > 1 )
+					{
+						return simd_dispatch( [ & ] <auto W> ( const_tag<W> ) FORCE_INLINE
+						{
+							hash_lanes<std::max<size_t>( XSTD_SHA_LANES, W / sizeof( uint32_t ) )>( messages, out );
+						} );
+					}
+				}
+			}
+			for ( size_t n = 0; n != messages.size(); n++ )
+			{
+				basic_sha h = {};
+				h.add_bytes( messages[ n ].data(), messages[ n ].size() );
+				out[ n ] = h.digest();
+			}
+		}
+		static std::vector<value_type> hash_many( std::span<const std::span<const uint8_t>> messages )
+		{
+			std::vector<value_type> result( messages.size() );
+			hash_many( messages, result );
+			return result;
+		}
+
 		// Explicit conversions.
 		//
 		constexpr uint32_t as32() const noexcept { return uint32_t( digest()[ 0 ] ); }
@@ -307,6 +469,82 @@ namespace xstd
 			for ( size_t n = 0; n != ivd.size(); n++ )
 				iv[ n ] += ivd[ n ];
 		}
+
+		// Number of messages to interleave in basic_sha::hash_many, two when the SHA extensions can be
+		// pipelined, otherwise one per SIMD lane.
+		//
+		inline static size_t batch_lanes()
+		{
+#if XSTD_HW_SHA1 && AMD64_TARGET && GNU_COMPILER
+			if ( HwAcccel && ia32::static_cpuid_s<7, 0, ia32::cpuid_eax_07>.ebx.sha )
+				return 2;
+#endif
+			return XSTD_SHA_LANES;
+		}
+
+		// Compresses one block into each of the N independent states.
+		//
+		template<size_t N>
+		FORCE_INLINE inline static void compress_lanes( std::array<value_type, N>& iv, const std::array<const uint8_t*, N>& blocks )
+		{
+#if XSTD_HW_SHA1 && AMD64_TARGET && GNU_COMPILER
+			if constexpr ( N == 2 ) {
+				if ( HwAcccel && ia32::static_cpuid_s<7, 0, ia32::cpuid_eax_07>.ebx.sha ) {
+					uint32_t* states[] = { iv[ 0 ].data(), iv[ 1 ].data() };
+					ia32::sha1_compress_x2( states, blocks.data() );
+					return;
+				}
+			}
+#endif
+#if XSTD_VECTOR_EXT
+			if constexpr ( N > 1 )
+			{
+				using vec = native_vector<uint32_t, N>;
+				constexpr auto vrotl = [ ] ( vec v, int n ) FORCE_INLINE { return ( v << n ) | ( v >> ( 32 - n ) ); };
+				constexpr auto f1 = [ ] ( vec x, vec y, vec z ) FORCE_INLINE { return z ^ ( x & ( y ^ z ) ); };
+				constexpr auto f2 = [ ] ( vec x, vec y, vec z ) FORCE_INLINE { return x ^ y ^ z; };
+				constexpr auto f3 = [ ] ( vec x, vec y, vec z ) FORCE_INLINE { return ( x & y ) | ( z & ( x | y ) ); };
+
+				// Transpose the message words and the state so that each lane holds one stream.
+				//
+				alignas( sizeof( vec ) ) vec workspace[ 16 ];
+				alignas( sizeof( vec ) ) vec sv[ 5 ];
+				for ( size_t i = 0; i != 16; i++ )
+					for ( size_t l = 0; l != N; l++ )
+						workspace[ i ][ l ] = bswapd( load_misaligned<uint32_t>( blocks[ l ] + i * 4 ) );
+				for ( size_t i = 0; i != 5; i++ )
+					for ( size_t l = 0; l != N; l++ )
+						sv[ i ][ l ] = iv[ l ][ i ];
+
+				// Rotate the register names instead of the values.
+				//
+				make_constant_series<80>( [ & ] <auto I> ( const_tag<I> ) FORCE_INLINE
+				{
+					if constexpr ( I >= 16 )
+						workspace[ I % 16 ] = vrotl( workspace[ ( I + 13 ) % 16 ] ^ workspace[ ( I + 8 ) % 16 ] ^ workspace[ ( I + 2 ) % 16 ] ^ workspace[ I % 16 ], 1 );
+
+					auto& a = sv[ ( 80 - I ) % 5 ];
+					auto& b = sv[ ( 81 - I ) % 5 ];
+					auto& c = sv[ ( 82 - I ) % 5 ];
+					auto& d = sv[ ( 83 - I ) % 5 ];
+					auto& e = sv[ ( 84 - I ) % 5 ];
+					if constexpr ( I < 20 )      e += f1( b, c, d );
+					else if constexpr ( I < 40 ) e += f2( b, c, d );
+					else if constexpr ( I < 60 ) e += f3( b, c, d );
+					else                         e += f2( b, c, d );
+					e += vrotl( a, 5 ) + workspace[ I % 16 ] + k_const[ I / 20 ];
+					b = vrotl( b, 30 );
+				} );
+
+				for ( size_t i = 0; i != 5; i++ )
+					for ( size_t l = 0; l != N; l++ )
+						iv[ l ][ i ] += sv[ i ][ l ];
+				return;
+			}
+#endif
+			for ( size_t l = 0; l != N; l++ )
+				compress( iv[ l ], blocks[ l ] );
+		}
 	};
 	using sha1 =   basic_sha<sha1_traits<true>>;
 	using sha1_t = typename sha1::value_type;
@@ -107,6 +107,86 @@ namespace xstd
 			for ( size_t n = 0; n != ivd.size(); n++ )
 				iv[ n ] += ivd[ n ];
 		}
+
+		// Number of messages to interleave in basic_sha::hash_many, two when the SHA extensions can be
+		// pipelined, otherwise one per SIMD lane.
+		//
+		inline static size_t batch_lanes()
+		{
+#if XSTD_HW_SHA256 && AMD64_TARGET && GNU_COMPILER
+			if ( HwAcccel && ia32::static_cpuid_s<7, 0, ia32::cpuid_eax_07>.ebx.sha )
+				return 2;
+#endif
+			return XSTD_SHA_LANES;
+		}
+
+		// Compresses one block into each of the N independent states.
+		//
+		template<size_t N>
+		FORCE_INLINE inline static void compress_lanes( std::array<value_type, N>& iv, const std::array<const uint8_t*, N>& blocks )
+		{
+#if XSTD_HW_SHA256 && AMD64_TARGET && GNU_COMPILER
+			if constexpr ( N == 2 ) {
+				if ( HwAcccel && ia32::static_cpuid_s<7, 0, ia32::cpuid_eax_07>.ebx.sha ) {
+					uint32_t* states[] = { iv[ 0 ].data(), iv[ 1 ].data() };
+					ia32::sha256_compress_x2( states, blocks.data(), k_const.data() );
+					return;
+				}
+			}
+#endif
+#if XSTD_VECTOR_EXT
+			if constexpr ( N > 1 )
+			{
+				using vec = native_vector<uint32_t, N>;
+				static constexpr auto vrotr = [ ] ( vec v, int n ) FORCE_INLINE { return ( v >> n ) | ( v << ( 32 - n ) ); };
+				constexpr auto e0 = [ ] ( vec v ) FORCE_INLINE { return vrotr( v, 2 ) ^ vrotr( v, 13 ) ^ vrotr( v, 22 ); };
+				constexpr auto e1 = [ ] ( vec v ) FORCE_INLINE { return vrotr( v, 6 ) ^ vrotr( v, 11 ) ^ vrotr( v, 25 ); };
+				constexpr auto s0 = [ ] ( vec v ) FORCE_INLINE { return vrotr( v, 7 ) ^ vrotr( v, 18 ) ^ ( v >> 3 ); };
+				constexpr auto s1 = [ ] ( vec v ) FORCE_INLINE { return vrotr( v, 17 ) ^ vrotr( v, 19 ) ^ ( v >> 10 ); };
+				constexpr auto ch = [ ] ( vec x, vec y, vec z ) FORCE_INLINE { return z ^ ( x & ( y ^ z ) ); };
+				constexpr auto maj = [ ] ( vec x, vec y, vec z ) FORCE_INLINE { return ( x & y ) | ( z & ( x | y ) ); };
+
+				// Transpose the message words and the state so that each lane holds one stream.
+				//
+				alignas( sizeof( vec ) ) vec workspace[ 16 ];
+				alignas( sizeof( vec ) ) vec sv[ 8 ];
+				for ( size_t i = 0; i != 16; i++ )
+					for ( size_t l = 0; l != N; l++ )
+						workspace[ i ][ l ] = bswapd( load_misaligned<uint32_t>( blocks[ l ] + i * 4 ) );
+				for ( size_t i = 0; i != 8; i++ )
+					for ( size_t l = 0; l != N; l++ )
+						sv[ i ][ l ] = iv[ l ][ i ];
+
+				// Rotate the register names instead of the values.
+				//
+				make_constant_series<64>( [ & ] <auto I> ( const_tag<I> ) FORCE_INLINE
+				{
+					if constexpr ( I >= 16 )
+						workspace[ I % 16 ] += s0( workspace[ ( I + 1 ) % 16 ] ) + s1( workspace[ ( I + 14 ) % 16 ] ) + workspace[ ( I + 9 ) % 16 ];
+
+					auto& a = sv[ ( 64 - I ) % 8 ];
+					auto& b = sv[ ( 65 - I ) % 8 ];
+					auto& c = sv[ ( 66 - I ) % 8 ];
+					auto& d = sv[ ( 67 - I ) % 8 ];
+					auto& e = sv[ ( 68 - I ) % 8 ];
+					auto& f = sv[ ( 69 - I ) % 8 ];
+					auto& g = sv[ ( 70 - I ) % 8 ];
+					auto& h = sv[ ( 71 - I ) % 8 ];
+					vec x = workspace[ I % 16 ] + h + e1( e ) + ch( e, f, g ) - k_const[ I ];
+					vec y = e0( a ) + maj( a, b, c );
+					d += x;
+					h = x + y;
+				} );
+
+				for ( size_t i = 0; i != 8; i++ )
+					for ( size_t l = 0; l != N; l++ )
+						iv[ l ][ i ] += sv[ i ][ l ];
+				return;
+			}
+#endif
+			for ( size_t l = 0; l != N; l++ )
+				compress( iv[ l ], blocks[ l ] );
+		}
 	};
 	using sha256 =   basic_sha<sha256_traits<true>>;
 	using sha256_t = typename sha256::value_type;
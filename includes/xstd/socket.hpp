@@ -11,6 +11,7 @@
 #include "task.hpp"
 #include "fiber.hpp"
 #include "async.hpp"
+#include "random.hpp"
 
 // Detect the underlying system libraries.
 //
@@ -35,6 +36,27 @@
 		#define XSTD_WINSOCK 0
 	#endif
 #endif
+#ifndef XSTD_EPOLL
+	#if XSTD_BERKELEY && !XSTD_WINSOCK && __has_include(<sys/epoll.h>)
+		#define XSTD_EPOLL 1
+	#else
+		#define XSTD_EPOLL 0
+	#endif
+#endif
+
+// [[Configuration]]
+// XSTD_REACTOR_COUNT: Number of epoll reactors (and their threads) shared by all sockets in the process.
+//
+#ifndef XSTD_REACTOR_COUNT
+	#define XSTD_REACTOR_COUNT 1
+#endif
+
+// [[Configuration]]
+// XSTD_DNS_RESOLVER: Installs the built-in caching resolver as the default DNS hook on epoll builds.
+//
+#ifndef XSTD_DNS_RESOLVER
+	#define XSTD_DNS_RESOLVER XSTD_EPOLL
+#endif
 
 // Include appropriately.
 //
@@ -62,9 +84,21 @@
 	#include <sys/socket.h>
 	#include <sys/types.h>
 	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
 	#include <poll.h>
 	#include <netdb.h>
+	#include <fcntl.h>
+	#include <unistd.h>
 	#include <thread>
+	#include <sys/uio.h>
+	#include <deque>
+	#if XSTD_EPOLL
+		#include <sys/epoll.h>
+		#include <linux/errqueue.h>
+		#include <unordered_map>
+		#include <cstdio>
+	#endif
 	#undef XSTD_LWIP
 	#undef XSTD_WINSOCK
 	#define XSTD_HAS_TCP 1
@@ -206,7 +240,12 @@ namespace xstd::net {
 		xstd::result<ipv4> await_resume() const { return std::move( result ); }
 	};
 	using fn_dns_hook = bool(*)( dns_query_awaitable*, std::coroutine_handle<> );
+#if XSTD_BERKELEY && XSTD_EPOLL && XSTD_DNS_RESOLVER
+	inline bool dns_resolver_hook( dns_query_awaitable* q, std::coroutine_handle<> hnd );
+	inline fn_dns_hook g_dns_hook = &dns_resolver_hook;
+#else
 	inline fn_dns_hook g_dns_hook = nullptr;
+#endif
 	inline dns_query_awaitable query_dns_a( const char* hostname, bool no_hook = false ) {
 		return { hostname, no_hook };
 	}
@@ -240,6 +279,8 @@ namespace xstd::net {
 		bool                          timestamps =     false;
 		bool                          reuse =          true;
 		std::optional<xstd::duration> keepalive =      std::nullopt;
+		uint32_t                      listen_shards =  1;  // Number of SO_REUSEPORT listeners a server opens, 0 for one per core.
+		uint32_t                      zerocopy_threshold = 0; // Sends of at least this many bytes use MSG_ZEROCOPY where supported, 0 to disable.
 	};
 
 	// Definition via Berkeley/Winsock:
@@ -349,6 +390,111 @@ namespace xstd::net {
 		}
 	};
 
+#if XSTD_EPOLL
+	// Shared epoll reactor, sockets register themselves in edge-triggered mode and get a callback on the
+	// reactor thread whenever their readiness changes instead of polling for it.
+	//
+	struct reactor {
+		// Registration entry, callback is invoked with the entry locked so that detaching synchronizes
+		// with any in-flight dispatch, entry itself is freed by the reactor thread once it's unreachable.
+		//
+		struct entry {
+			spinlock   lock = {};
+			void*      ctx = nullptr;
+			void( *    callback )( void* ctx, uint32_t events ) = nullptr;
+			socket_t   fd = invalid_socket;
+			entry*     next_retired = nullptr;
+		};
+
+		int                epfd = -1;
+		std::atomic<bool>  started = false;
+		spinlock           state_lock = {};
+		spinlock           retire_lock = {};
+		entry*             retired = nullptr;
+
+		// Gets the reactor responsible for the given descriptor, instances are never destroyed since the threads are detached.
+		//
+		static reactor& get( socket_t fd ) {
+			static reactor* instances = new reactor[ XSTD_REACTOR_COUNT ];
+			return instances[ size_t( fd ) % XSTD_REACTOR_COUNT ];
+		}
+
+		// Starts the reactor thread if not already running.
+		//
+		socket_error start() {
+			if ( started.load( std::memory_order::acquire ) ) [[likely]]
+				return 0;
+			std::lock_guard _g{ state_lock };
+			if ( started.load( std::memory_order::relaxed ) )
+				return 0;
+			epfd = ::epoll_create1( EPOLL_CLOEXEC );
+			if ( epfd == -1 )
+				return detail::get_last_error( -1 );
+			std::thread{ [ this ] { run(); } }.detach();
+			started.store( true, std::memory_order::release );
+			return 0;
+		}
+
+		// Reactor loop.
+		//
+		void run() {
+			epoll_event events[ 256 ];
+			while ( true ) {
+				// Free the entries retired before the previous wait, they can no longer be in any dispatch.
+				//
+				entry* free_list;
+				{
+					std::lock_guard _g{ retire_lock };
+					free_list = std::exchange( retired, nullptr );
+				}
+				while ( free_list )
+					delete std::exchange( free_list, free_list->next_retired );
+
+				// Wait for events and dispatch them.
+				//
+				int count = ::epoll_wait( epfd, events, (int) std::size( events ), -1 );
+				for ( int i = 0; i < count; i++ ) {
+					auto* e = (entry*) events[ i ].data.ptr;
+					std::lock_guard _g{ e->lock };
+					if ( e->ctx ) {
+						e->callback( e->ctx, events[ i ].events );
+					}
+				}
+			}
+		}
+
+		// Attaches a descriptor to the reactor.
+		//
+		socket_error attach( entry*& out, socket_t fd, void* ctx, void( *callback )( void*, uint32_t ), uint32_t events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET ) {
+			if ( auto err = start() )
+				return err;
+
+			auto* e = new entry{ .ctx = ctx, .callback = callback, .fd = fd };
+			epoll_event desc = { .events = events, .data = { .ptr = e } };
+			if ( ::epoll_ctl( epfd, EPOLL_CTL_ADD, fd, &desc ) == -1 ) {
+				delete e;
+				return detail::get_last_error( -1 );
+			}
+			out = e;
+			return 0;
+		}
+
+		// Detaches an entry, no callbacks will be invoked after this returns.
+		//
+		void detach( entry* e ) {
+			if ( !e ) return;
+			::epoll_ctl( epfd, EPOLL_CTL_DEL, e->fd, nullptr );
+			{
+				std::lock_guard _g{ e->lock };
+				e->ctx = nullptr;
+			}
+			std::lock_guard _g{ retire_lock };
+			e->next_retired = retired;
+			retired = e;
+		}
+	};
+#endif
+
 	// Implement DNS resolution.
 	//
 	inline bool dns_query_awaitable::await_suspend( std::coroutine_handle<> hnd ) {
@@ -393,6 +539,496 @@ namespace xstd::net {
 		return false;
 	}
 
+#if XSTD_EPOLL && XSTD_DNS_RESOLVER
+	// Caching stub resolver, queries the nameserver over a non-blocking UDP socket driven by the reactor instead of
+	// blocking a worker in getaddrinfo. Positive answers are cached for their TTL, negative ones for the SOA minimum,
+	// concurrent lookups of the same name share a single query. Single-label names not found in the hosts file are
+	// forwarded to the system resolver so that search domains keep working.
+	//
+	struct dns_resolver {
+		// Cache entry, null address indicates a negative entry.
+		//
+		struct cache_entry {
+			ipv4              address = {};
+			timestamp         expiry = {};
+		};
+
+		// In-flight query and everyone waiting for it.
+		//
+		struct pending_query {
+			std::string                        name;
+			uint16_t                           id = 0;
+			uint8_t                            attempt = 0;
+			std::vector<dns_query_awaitable*>  waiters = {};
+		};
+
+		// Options, should be set before the first query.
+		//
+		xstd::duration    timeout =      1s;     // Time to wait for an answer before retransmitting.
+		uint8_t           attempts =     3;      // Number of transmissions before giving up.
+		xstd::duration    max_ttl =      1h;     // Upper bound of the cache lifetime of any answer.
+		xstd::duration    negative_ttl = 30s;    // Lifetime of negative answers without an SOA record.
+		size_t            max_entries =  4096;   // Size of the cache after which expired entries are purged.
+
+		// Resolver state.
+		//
+		spinlock                                        lock = {};
+		bool                                            initialized = false;
+		ipv4                                            nameserver = {};
+		uint16_t                                        nameserver_port = 53;
+		socket_t                                        fd = invalid_socket;
+		reactor::entry*                                 reactor_entry = nullptr;
+		std::unordered_map<std::string, ipv4>           hosts;
+		std::unordered_map<std::string, cache_entry>    cache;
+		std::unordered_map<std::string, pending_query*> pending_by_name;
+		std::unordered_map<uint16_t, pending_query*>    pending_by_id;
+
+		// Gets the global instance, never destroyed since the reactor may still reference it.
+		//
+		static dns_resolver& get() {
+			static dns_resolver* instance = new dns_resolver();
+			return *instance;
+		}
+
+		// Changes the nameserver, drops the cache and reopens the socket, queries in flight are retransmitted to the new server.
+		//
+		void set_nameserver( ipv4 address, uint16_t port = 53 ) {
+			std::unique_lock g{ lock };
+			load_system_config();
+			nameserver = address;
+			nameserver_port = port;
+			cache.clear();
+			close_socket( g );
+		}
+
+		// Drops all cached answers.
+		//
+		void flush() {
+			std::lock_guard _g{ lock };
+			cache.clear();
+		}
+
+		// Starts the lookup, returns false if the result is already available.
+		//
+		bool query( dns_query_awaitable* q, std::coroutine_handle<> hnd ) {
+			std::string name;
+			if ( !canonicalize( name, q->hostname ) ) {
+				q->result.raise( xstd::exception{ XSTD_ESTR( "invalid hostname: '%s'" ), q->hostname } );
+				return false;
+			}
+
+			std::unique_lock g{ lock };
+			load_system_config();
+
+			// Try the hosts file and the cache.
+			//
+			if ( auto it = hosts.find( name ); it != hosts.end() ) {
+				q->result.emplace( it->second );
+				return false;
+			}
+			if ( auto it = cache.find( name ); it != cache.end() ) {
+				if ( time::now() < it->second.expiry ) {
+					if ( it->second.address ) {
+						q->result.emplace( it->second.address );
+					} else {
+						q->result.raise( xstd::exception{ XSTD_ESTR( "failed to query dns: '%s' does not exist" ), q->hostname } );
+					}
+					return false;
+				}
+				cache.erase( it );
+			}
+
+			// If there is no nameserver or this is a single-label name, let the system resolver handle it.
+			//
+			if ( !nameserver || name.find( '.' ) == std::string::npos ) {
+				g.unlock();
+				xstd::chore( [ q, hnd ]
+				{
+					q->no_hook = true;
+					if ( !q->await_suspend( hnd ) )
+						hnd();
+				} );
+				return true;
+			}
+
+			// Join the query in flight if there is one.
+			//
+			q->continuation = hnd;
+			if ( auto it = pending_by_name.find( name ); it != pending_by_name.end() ) {
+				it->second->waiters.emplace_back( q );
+				return true;
+			}
+
+			// Start a new query.
+			//
+			if ( auto err = open_socket() ) {
+				q->result.raise( xstd::exception{ XSTD_ESTR( "failed to open dns socket: %d" ), err } );
+				return false;
+			}
+			auto* p = new pending_query{ .name = std::move( name ), .id = allocate_id() };
+			p->waiters.emplace_back( q );
+			pending_by_name.emplace( p->name, p );
+			pending_by_id.emplace( p->id, p );
+			transmit( p );
+			return true;
+		}
+
+	private:
+		// Result of a parsed response.
+		//
+		enum class response_status {
+			ignore,       // Not a response to the query.
+			found,        // Address record found.
+			nonexistent,  // Name or record does not exist, cacheable.
+			failure,      // Server failure or unusable answer, not cacheable.
+		};
+
+		// Lowercases the name, strips the trailing dot and validates the label lengths.
+		//
+		static bool canonicalize( std::string& out, const char* hostname ) {
+			std::string_view src{ hostname };
+			if ( !src.empty() && src.back() == '.' )
+				src.remove_suffix( 1 );
+			if ( src.empty() || src.size() > 253 )
+				return false;
+
+			out.resize( src.size() );
+			size_t label = 0;
+			for ( size_t i = 0; i != src.size(); i++ ) {
+				char c = src[ i ];
+				if ( c == '.' ) {
+					if ( !label ) return false;
+					label = 0;
+				} else if ( ++label > 63 || c <= ' ' ) {
+					return false;
+				}
+				out[ i ] = ( 'A' <= c && c <= 'Z' ) ? char( c | 0x20 ) : c;
+			}
+			return label != 0;
+		}
+
+		// Encodes a recursive query for the A record of the name.
+		//
+		static size_t encode_query( uint8_t* out, uint16_t id, std::string_view name ) {
+			uint8_t header[ 12 ] = { uint8_t( id >> 8 ), uint8_t( id ), 0x01, 0x00, 0x00, 0x01 };
+			memcpy( out, header, sizeof( header ) );
+			uint8_t* it = out + sizeof( header );
+			while ( true ) {
+				size_t n = std::min( name.find( '.' ), name.size() );
+				*it++ = uint8_t( n );
+				memcpy( it, name.data(), n );
+				it += n;
+				if ( n == name.size() ) break;
+				name.remove_prefix( n + 1 );
+			}
+			*it++ = 0;
+			*it++ = 0; *it++ = 1; // QTYPE  = A
+			*it++ = 0; *it++ = 1; // QCLASS = IN
+			return it - out;
+		}
+
+		// Skips over a possibly compressed name.
+		//
+		static bool skip_name( std::span<const uint8_t> msg, size_t& pos ) {
+			while ( pos < msg.size() ) {
+				uint8_t len = msg[ pos ];
+				if ( ( len & 0xC0 ) == 0xC0 ) {
+					pos += 2;
+					return pos <= msg.size();
+				} else if ( len & 0xC0 ) {
+					return false;
+				}
+				pos += 1 + len;
+				if ( !len ) return true;
+			}
+			return false;
+		}
+
+		// Parses a response to the given query.
+		//
+		static response_status parse_response( std::span<const uint8_t> msg, std::span<const uint8_t> query, ipv4& address, uint32_t& ttl ) {
+			auto rd16 = [ & ]( size_t pos ) { return uint16_t( ( msg[ pos ] << 8 ) | msg[ pos + 1 ] ); };
+			auto rd32 = [ & ]( size_t pos ) { return ( uint32_t( rd16( pos ) ) << 16 ) | rd16( pos + 2 ); };
+
+			// Validate the header and make sure the question matches ours.
+			//
+			if ( msg.size() < query.size() || msg[ 0 ] != query[ 0 ] || msg[ 1 ] != query[ 1 ] || !( msg[ 2 ] & 0x80 ) )
+				return response_status::ignore;
+			if ( rd16( 4 ) != 1 )
+				return response_status::ignore;
+			for ( size_t i = 12; i != query.size(); i++ ) {
+				uint8_t a = msg[ i ], b = query[ i ];
+				if ( a != b && !( 'A' <= a && a <= 'Z' && ( a | 0x20 ) == b ) )
+					return response_status::ignore;
+			}
+
+			uint8_t rcode = msg[ 3 ] & 0xF;
+			if ( rcode != 0 && rcode != 3 )
+				return response_status::failure;
+
+			// Walk the answer section for the first address record, TTL is the minimum of the chain leading to it.
+			//
+			size_t pos = query.size();
+			uint16_t answers = rd16( 6 ), authorities = rd16( 8 );
+			ttl = UINT32_MAX;
+			for ( uint16_t i = 0; i != answers; i++ ) {
+				if ( !skip_name( msg, pos ) || ( pos + 10 ) > msg.size() )
+					return response_status::failure;
+				uint16_t type = rd16( pos ), cls = rd16( pos + 2 ), len = rd16( pos + 8 );
+				uint32_t rttl = rd32( pos + 4 );
+				pos += 10;
+				if ( ( pos + len ) > msg.size() )
+					return response_status::failure;
+				if ( cls == 1 && ( type == 1 || type == 5 ) ) {
+					ttl = std::min( ttl, rttl );
+					if ( type == 1 && len == 4 ) {
+						address = ipv4{ msg[ pos ], msg[ pos + 1 ], msg[ pos + 2 ], msg[ pos + 3 ] };
+						return response_status::found;
+					}
+				}
+				pos += len;
+			}
+
+			// Truncated without an answer, we cannot tell if the name exists.
+			//
+			if ( msg[ 2 ] & 0x02 )
+				return response_status::failure;
+
+			// Negative answer, take the TTL from the SOA record if there is one.
+			//
+			ttl = UINT32_MAX;
+			for ( uint16_t i = 0; i != authorities; i++ ) {
+				if ( !skip_name( msg, pos ) || ( pos + 10 ) > msg.size() )
+					break;
+				uint16_t type = rd16( pos ), len = rd16( pos + 8 );
+				uint32_t rttl = rd32( pos + 4 );
+				pos += 10;
+				if ( ( pos + len ) > msg.size() )
+					break;
+				if ( type == 6 && len >= 4 ) {
+					ttl = std::min( rttl, rd32( pos + len - 4 ) );
+					break;
+				}
+				pos += len;
+			}
+			return response_status::nonexistent;
+		}
+
+		// Reads the nameserver from resolv.conf and the address entries from the hosts file, once.
+		//
+		void load_system_config() {
+			if ( initialized ) return;
+			initialized = true;
+
+			char line[ 512 ];
+			if ( FILE* f = fopen( "/etc/resolv.conf", "r" ) ) {
+				while ( !nameserver && fgets( line, sizeof( line ), f ) ) {
+					char addr[ 64 ];
+					if ( sscanf( line, " nameserver %63s", addr ) == 1 ) {
+						size_t count = std::dynamic_extent;
+						if ( auto ip = ipv4::parse( addr, count ); ip && !addr[ count ] )
+							nameserver = ip;
+					}
+				}
+				fclose( f );
+			}
+			if ( FILE* f = fopen( "/etc/hosts", "r" ) ) {
+				while ( fgets( line, sizeof( line ), f ) ) {
+					if ( char* c = strchr( line, '#' ) )
+						*c = 0;
+					char* save = nullptr;
+					char* tok = strtok_r( line, " \t\r\n", &save );
+					if ( !tok ) continue;
+					size_t count = std::dynamic_extent;
+					auto ip = ipv4::parse( tok, count );
+					if ( !ip || tok[ count ] ) continue;
+					while ( ( tok = strtok_r( nullptr, " \t\r\n", &save ) ) ) {
+						std::string name;
+						if ( canonicalize( name, tok ) )
+							hosts.emplace( std::move( name ), ip );
+					}
+				}
+				fclose( f );
+			}
+		}
+
+		// Opens the socket if not already open, must be called with the lock held.
+		//
+		socket_error open_socket() {
+			if ( fd != invalid_socket )
+				return 0;
+
+			socket_t sock;
+			if ( auto err = detail::create_socket( &sock, AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC ) )
+				return err;
+			sockaddr_in addr = {};
+			addr.sin_family = AF_INET;
+			addr.sin_port = htons( nameserver_port );
+			addr.sin_addr.s_addr = nameserver.to_integer();
+			if ( ::connect( sock, (sockaddr*) &addr, sizeof( addr ) ) == -1 ) {
+				auto err = detail::get_last_error( -1 );
+				detail::close_socket( sock );
+				return err;
+			}
+			if ( auto err = reactor::get( sock ).attach( reactor_entry, sock, this, &on_ready, EPOLLIN | EPOLLET ) ) {
+				detail::close_socket( sock );
+				return err;
+			}
+			fd = sock;
+			return 0;
+		}
+
+		// Closes the socket, detaching has to happen without the lock since the callback acquires it.
+		//
+		void close_socket( std::unique_lock<spinlock>& g ) {
+			socket_t sock = std::exchange( fd, invalid_socket );
+			auto* entry = std::exchange( reactor_entry, nullptr );
+			if ( sock == invalid_socket )
+				return;
+			g.unlock();
+			reactor::get( sock ).detach( entry );
+			detail::close_socket( sock );
+			g.lock();
+		}
+
+		// Picks an unused random transaction identifier.
+		//
+		uint16_t allocate_id() {
+			while ( true ) {
+				uint16_t id = make_random<uint16_t>();
+				if ( !pending_by_id.contains( id ) )
+					return id;
+			}
+		}
+
+		// Sends the query and arms the retransmission timer, must be called with the lock held.
+		//
+		void transmit( pending_query* p ) {
+			uint8_t buffer[ 512 ];
+			size_t length = encode_query( buffer, p->id, p->name );
+			if ( fd == invalid_socket )
+				open_socket();
+			if ( fd != invalid_socket )
+				::send( fd, buffer, length, MSG_NOSIGNAL );
+
+			xstd::chore( [ this, id = p->id, attempt = p->attempt ]
+			{
+				std::vector<dns_query_awaitable*> waiters;
+				{
+					std::lock_guard _g{ lock };
+					auto it = pending_by_id.find( id );
+					if ( it == pending_by_id.end() || it->second->attempt != attempt )
+						return;
+					auto* p = it->second;
+					if ( ++p->attempt < attempts ) {
+						transmit( p );
+						return;
+					}
+					waiters = retire( p );
+				}
+				for ( auto* q : waiters ) {
+					q->result.raise( xstd::exception{ XSTD_ESTR( "failed to query dns: '%s' timed out" ), q->hostname } );
+					xstd::chore( q->continuation );
+				}
+			}, timeout );
+		}
+
+		// Removes the query from the pending list and returns the waiters, must be called with the lock held.
+		//
+		std::vector<dns_query_awaitable*> retire( pending_query* p ) {
+			auto waiters = std::move( p->waiters );
+			pending_by_name.erase( p->name );
+			pending_by_id.erase( p->id );
+			delete p;
+			return waiters;
+		}
+
+		// Inserts an entry into the cache, purging expired entries once it grows past the limit.
+		//
+		void insert( const std::string& name, ipv4 address, xstd::duration ttl ) {
+			if ( ttl <= 0s )
+				return;
+			auto now = time::now();
+			if ( cache.size() >= max_entries ) {
+				std::erase_if( cache, [ & ]( auto& kv ) { return kv.second.expiry <= now; } );
+				if ( cache.size() >= max_entries )
+					cache.clear();
+			}
+			cache.insert_or_assign( name, cache_entry{ address, now + std::min( ttl, max_ttl ) } );
+		}
+
+		// Completed waiter, resumed after the lock is released.
+		//
+		struct completion {
+			dns_query_awaitable* query;
+			response_status      status;
+			ipv4                 address;
+		};
+
+		// Handles a single datagram and collects the completed waiters, must be called with the lock held.
+		//
+		void handle( std::span<const uint8_t> msg, std::vector<completion>& completions ) {
+			if ( msg.size() < 12 )
+				return;
+			auto it = pending_by_id.find( uint16_t( ( msg[ 0 ] << 8 ) | msg[ 1 ] ) );
+			if ( it == pending_by_id.end() )
+				return;
+			auto* p = it->second;
+
+			uint8_t query[ 512 ];
+			size_t query_length = encode_query( query, p->id, p->name );
+			ipv4 address = {};
+			uint32_t ttl = 0;
+			auto status = parse_response( msg, { query, query_length }, address, ttl );
+			if ( status == response_status::ignore )
+				return;
+
+			if ( status == response_status::found ) {
+				insert( p->name, address, 1s * ttl );
+			} else if ( status == response_status::nonexistent ) {
+				insert( p->name, {}, ttl == UINT32_MAX ? negative_ttl : 1s * ttl );
+			}
+			for ( auto* q : retire( p ) ) {
+				completions.push_back( { q, status, address } );
+			}
+		}
+
+		// Readiness callback, invoked from the reactor thread.
+		//
+		static void on_ready( void* ctx, uint32_t ) {
+			auto* self = (dns_resolver*) ctx;
+
+			std::vector<completion> completions;
+			{
+				std::lock_guard _g{ self->lock };
+				uint8_t buffer[ 1500 ];
+				while ( self->fd != invalid_socket ) {
+					ssize_t n = ::recv( self->fd, buffer, sizeof( buffer ), 0 );
+					if ( n < 0 ) {
+						if ( errno == EINTR ) continue;
+						break;
+					}
+					self->handle( { buffer, size_t( n ) }, completions );
+				}
+			}
+
+			for ( auto [q, status, address] : completions ) {
+				if ( status == response_status::found ) {
+					q->result.emplace( address );
+				} else if ( status == response_status::nonexistent ) {
+					q->result.raise( xstd::exception{ XSTD_ESTR( "failed to query dns: '%s' does not exist" ), q->hostname } );
+				} else {
+					q->result.raise( xstd::exception{ XSTD_ESTR( "failed to query dns: '%s' server failure" ), q->hostname } );
+				}
+				xstd::chore( q->continuation );
+			}
+		}
+	};
+	inline bool dns_resolver_hook( dns_query_awaitable* q, std::coroutine_handle<> hnd ) {
+		return dns_resolver::get().query( q, hnd );
+	}
+#endif
+
 	// Base of the stream.
 	//
 	struct socket : duplex {
@@ -417,20 +1053,23 @@ namespace xstd::net {
 		// Wrappers.
 		//
 	public:
-		socket_error set_socket_opt( int level, int name, const void* data, size_t len ) {
-			socket_error status = ::setsockopt( fd, level, name, (const char*) data, (int) len );
+		socket_error set_socket_opt( socket_t sock, int level, int name, const void* data, size_t len ) {
+			socket_error status = ::setsockopt( sock, level, name, (const char*) data, (int) len );
 #if XSTD_WINSOCK
 			status = status == -1 ? detail::get_last_error( status ) : 0;
 #endif
 			return status;
 		}
+		socket_error set_socket_opt( int level, int name, const void* data, size_t len ) {
+			return set_socket_opt( this->fd, level, name, data, len );
+		}
 		socket_error get_socket_opt( int level, int name, void* data, size_t* len ) {
-			int rlen = (int) *len;
+			socklen_t rlen = (socklen_t) *len;
 			socket_error status = ::getsockopt( this->fd, level, name, (char*) data, &rlen );
 #if XSTD_WINSOCK
 			status = status == -1 ? detail::get_last_error( status ) : 0;
 #endif
-			if ( !status ) *len = (size_t) std::max( 0, rlen );
+			if ( !status ) *len = (size_t) std::max<int64_t>( 0, rlen );
 			return status;
 		}
 		template<typename T>
@@ -493,23 +1132,26 @@ namespace xstd::net {
 #endif
 			return 0;
 		}
-		socket_error socket_bind() {
+		socket_error socket_bind( socket_t sock ) {
 			sockaddr_in addr;
 			memset( &addr, 0, sizeof( sockaddr_in ) );
 			addr.sin_family = AF_INET;
 			addr.sin_port = bswap( this->port );
 			addr.sin_addr.s_addr = this->address;
 #if XSTD_WINSOCK
-			if ( ::bind( this->fd, (const sockaddr*) &addr, sizeof( addr ) ) == -1 ) {
+			if ( ::bind( sock, (const sockaddr*) &addr, sizeof( addr ) ) == -1 ) {
 				return detail::get_last_error( -1 );
 			}
 #else
-			if ( ::bind( this->fd, (const sockaddr*) &addr, sizeof( addr ) ) == -1 ) {
+			if ( ::bind( sock, (const sockaddr*) &addr, sizeof( addr ) ) == -1 ) {
 				return detail::get_last_error( -1 );
 			}
 #endif
 			return 0;
 		}
+		socket_error socket_bind() {
+			return socket_bind( this->fd );
+		}
 		socket_error socket_poll( pollfd& desc, duration timeout ) {
 #if XSTD_WINSOCK
 			if ( ::WSAPoll( &desc, 1, timeout / 1ms ) == -1 ) {
@@ -522,23 +1164,31 @@ namespace xstd::net {
 #endif
 			return 0;
 		}
-		socket_error socket_listen() {
-			if ( ::listen( this->fd, opt.listen_backlog ) == -1 ) {
+		socket_error socket_listen( socket_t sock ) {
+			if ( ::listen( sock, opt.listen_backlog ) == -1 ) {
 				return detail::get_last_error( -1 );
 			}
 			return 0;
 		}
-		std::tuple<socket_t, ipv4, uint16_t> socket_accept() {
+		socket_error socket_listen() {
+			return socket_listen( this->fd );
+		}
+		std::tuple<socket_t, ipv4, uint16_t> socket_accept( socket_t sock ) {
 			sockaddr_in addr;
 			memset( &addr, 0, sizeof( sockaddr_in ) );
-			int len = sizeof( addr );
-			socket_t sock;
+			socklen_t len = sizeof( addr );
+			socket_t result;
 #if XSTD_WINSOCK
-			sock = ::WSAAccept( this->fd, (sockaddr*) &addr, &len, nullptr, 0 );
+			result = ::WSAAccept( sock, (sockaddr*) &addr, &len, nullptr, 0 );
+#elif XSTD_EPOLL
+			result = ::accept4( sock, (sockaddr*) &addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC );
 #else
-			sock = ::accept( this->fd, (sockaddr*) &addr, &len );
+			result = ::accept( sock, (sockaddr*) &addr, &len );
 #endif
-			return { sock, addr.sin_addr.s_addr, bswap( addr.sin_port ) };
+			return { result, addr.sin_addr.s_addr, bswap( addr.sin_port ) };
+		}
+		std::tuple<socket_t, ipv4, uint16_t> socket_accept() {
+			return socket_accept( this->fd );
 		}
 		bool socket_receive( std::span<uint8_t>& buffer, int flags = 0 ) {
 			bool need_poll = false;
@@ -562,6 +1212,7 @@ namespace xstd::net {
 				if ( auto e = detail::get_last_error( result ); e != EINTR && e != EINPROGRESS && e != EAGAIN && e != EWOULDBLOCK ) {
 					this->raise_error( XSTD_ESTR( "socket error: %d" ), e );
 				}
+				buffer = buffer.subspan( 0, 0 );
 				need_poll = true;
 			} else {
 				buffer = buffer.subspan( 0, (uint32_t) result );
@@ -585,8 +1236,6 @@ namespace xstd::net {
 			if ( socket_error result = ::send( this->fd, (char*) buffer.data(), (int)write_count, flags ); result == -1 ) [[unlikely]] {
 				if ( auto e = detail::get_last_error( result ); e != EINTR && e != EINPROGRESS && e != EAGAIN && e != EWOULDBLOCK ) {
 					this->raise_error( XSTD_ESTR( "socket error: %d" ), e );
-				} else if ( e == EWOULDBLOCK || e == EAGAIN ) {
-					count = write_count;
 				}
 				need_poll = true;
 			} else {
@@ -597,6 +1246,134 @@ namespace xstd::net {
 			return need_poll;
 		}
 
+#if !XSTD_WINSOCK
+		// Scatter-gather send queue, buffers sent with MSG_ZEROCOPY are moved to the in-flight list once fully
+		// submitted and are only released after the kernel reports the completion of their sequence number.
+		//
+		struct send_entry {
+			vec_buffer data;
+			size_t     offset = 0;
+			uint32_t   zc_seq = 0;
+			bool       zc_ref = false;
+		};
+		struct send_queue {
+			std::deque<send_entry>                     pending =        {};
+			std::deque<send_entry>                     inflight =       {};
+			size_t                                     pending_bytes =  0;
+			size_t                                     inflight_bytes = 0;
+			uint32_t                                   zc_next =        0;
+			uint32_t                                   zc_done =        0;  // All sequence numbers before this one are complete.
+			std::vector<std::pair<uint32_t, uint32_t>> zc_ranges =      {}; // Out of order completions.
+
+			void push( vec_buffer&& data ) {
+				pending_bytes += data.size();
+				pending.emplace_back( send_entry{ std::move( data ) } );
+			}
+			void complete( uint32_t lo, uint32_t hi ) {
+				zc_ranges.emplace_back( lo, hi );
+				for ( size_t i = 0; i != zc_ranges.size(); ) {
+					auto [a, b] = zc_ranges[ i ];
+					if ( int32_t( a - zc_done ) <= 0 ) {
+						if ( int32_t( b + 1 - zc_done ) > 0 )
+							zc_done = b + 1;
+						zc_ranges.erase( zc_ranges.begin() + i );
+						i = 0;
+					} else {
+						i++;
+					}
+				}
+				while ( !inflight.empty() && int32_t( inflight.front().zc_seq - zc_done ) < 0 ) {
+					inflight_bytes -= inflight.front().data.size();
+					inflight.pop_front();
+				}
+			}
+		};
+		bool socket_send( send_queue& queue, size_t zerocopy_threshold = 0 ) {
+			// Build the vector.
+			//
+			iovec  iov[ 64 ];
+			size_t iov_count = 0;
+			size_t total = 0;
+			for ( auto& e : queue.pending ) {
+				size_t n = e.data.size() - e.offset;
+				iov[ iov_count++ ] = { e.data.data() + e.offset, n };
+				total += n;
+				if ( iov_count == std::size( iov ) || total >= opt.sendbuf )
+					break;
+			}
+			if ( !iov_count ) return false;
+
+			// Submit it.
+			//
+			int  flags = MSG_NOSIGNAL;
+#ifdef MSG_ZEROCOPY
+			bool zc = zerocopy_threshold && total >= zerocopy_threshold;
+			if ( zc ) flags |= MSG_ZEROCOPY;
+#else
+			bool zc = false;
+#endif
+			msghdr msg = {};
+			msg.msg_iov = iov;
+			msg.msg_iovlen = iov_count;
+			ssize_t result = ::sendmsg( this->fd, &msg, flags );
+			if ( result == -1 ) [[unlikely]] {
+				auto e = detail::get_last_error( -1 );
+				if ( zc && e == ENOBUFS ) {
+					return socket_send( queue, 0 );
+				} else if ( e != EINTR && e != EINPROGRESS && e != EAGAIN && e != EWOULDBLOCK ) {
+					this->raise_error( XSTD_ESTR( "socket error: %d" ), e );
+				}
+				return true;
+			}
+
+			// Consume the sent range.
+			//
+			uint32_t seq = zc ? queue.zc_next++ : 0;
+			size_t   count = (size_t) result;
+			queue.pending_bytes -= count;
+			while ( count ) {
+				auto& e = queue.pending.front();
+				size_t n = std::min( e.data.size() - e.offset, count );
+				if ( zc ) {
+					e.zc_seq = seq;
+					e.zc_ref = true;
+				}
+				e.offset += n;
+				count -= n;
+				if ( e.offset != e.data.size() )
+					break;
+				if ( e.zc_ref ) {
+					queue.inflight_bytes += e.data.size();
+					queue.inflight.emplace_back( std::move( e ) );
+				}
+				queue.pending.pop_front();
+			}
+			return false;
+		}
+#if XSTD_EPOLL && defined( SO_ZEROCOPY )
+		void socket_reap_zerocopy( send_queue& queue ) {
+			while ( true ) {
+				alignas( cmsghdr ) char control[ 128 ];
+				msghdr msg = {};
+				msg.msg_control = control;
+				msg.msg_controllen = sizeof( control );
+				if ( ::recvmsg( this->fd, &msg, MSG_ERRQUEUE ) == -1 )
+					break;
+				for ( cmsghdr* cm = CMSG_FIRSTHDR( &msg ); cm; cm = CMSG_NXTHDR( &msg, cm ) ) {
+					if ( cm->cmsg_level != SOL_IP || cm->cmsg_type != IP_RECVERR )
+						continue;
+					auto* err = (sock_extended_err*) CMSG_DATA( cm );
+					if ( err->ee_errno || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY )
+						continue;
+					queue.complete( err->ee_info, err->ee_data );
+				}
+			}
+		}
+#else
+		void socket_reap_zerocopy( send_queue& ) {}
+#endif
+#endif
+
 		// Remote/local address.
 		//
 		std::pair<ipv4, uint16_t> get_remote_address() {
@@ -606,7 +1383,7 @@ namespace xstd::net {
 			sockaddr_in addr;
 			memset( &addr, 0, sizeof( sockaddr_in ) );
 			addr.sin_family = AF_INET;
-			int len = sizeof( sockaddr_in );
+			socklen_t len = sizeof( sockaddr_in );
 			getsockname( this->fd, (sockaddr*) &addr, &len );
 			return { addr.sin_addr.s_addr, bswap( addr.sin_port ) };
 		}
@@ -707,15 +1484,179 @@ namespace xstd::net {
 
 			// Start the initial fiber.
 			//
+#if XSTD_EPOLL
+			fib_main = main_reactor( is_connect );
+			fib_main.resume();
+#else
 			fib_main = main( is_connect );
+#endif
 		}
 		~tcp() {
+#if XSTD_EPOLL
+			fib_main.destroy();
+			if ( reactor_entry ) {
+				reactor::get( fd ).detach( reactor_entry );
+			}
+#endif
 			close();
 			stop( stream_stop_killed, XSTD_ESTR( "dropped" ) );
 		}
 
 	protected:
 		fiber fib_main;
+#if XSTD_EPOLL
+		fiber              fib_sender;
+		fiber              fib_receiver;
+		reactor::entry*    reactor_entry = nullptr;
+		std::atomic<bool>  connected = false;
+
+		// State of a pending connection, shared with the timeout chore which only resumes the main fiber if it moves
+		// the state out of pending before the connection is settled.
+		//
+		enum connect_state : uint8_t {
+			connect_pending,
+			connect_settled,
+			connect_timed_out,
+		};
+
+		// Readiness callback, invoked from the reactor thread.
+		//
+		static void on_ready( void* ctx, uint32_t events ) {
+			auto* self = (tcp*) ctx;
+			if ( !self->connected.load( std::memory_order::acquire ) ) {
+				self->fib_main.resume();
+				return;
+			}
+			if ( events & ( EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR ) )
+				self->fib_receiver.resume();
+			if ( events & ( EPOLLOUT | EPOLLHUP | EPOLLERR ) )
+				self->fib_sender.resume();
+		}
+		fiber main_reactor( bool connect ) {
+			// Wait for the constructor to assign fib_main, set the socket non-blocking.
+			//
+			co_yield {};
+			if ( auto err = detail::set_blocking( fd, false ) ) {
+				co_return this->raise_error( XSTD_ESTR( "failed to change socket mode: %d" ), err );
+			}
+
+			// Start the connection.
+			//
+			if ( connect ) {
+				if ( auto err = this->socket_connect(); err.has_value() ) {
+					co_return this->raise_error( XSTD_ESTR( "connection failed: %d" ), *err );
+				}
+				if ( stopped() ) co_return;
+			}
+
+			// Enable zero-copy sends if requested.
+			//
+#ifdef SO_ZEROCOPY
+			if ( opt.zerocopy_threshold ) {
+				zerocopy = this->set_socket_opt( SOL_SOCKET, SO_ZEROCOPY, 1 ) == 0;
+			}
+#endif
+
+			// Create the data fibers, they are parked until resumed by us or by the reactor, then register the socket.
+			//
+			fib_receiver = recv_more();
+			fib_sender = send_more();
+			if ( auto err = reactor::get( fd ).attach( reactor_entry, fd, this, &on_ready ) ) {
+				co_return this->raise_error( XSTD_ESTR( "failed to register socket: %d" ), err );
+			}
+
+			// Wait until socket is writable, schedule a wake-up for the timeout.
+			//
+			if ( connect ) {
+				auto state = std::make_shared<std::atomic<connect_state>>( connect_pending );
+				xstd::chore( [ state, fib = fiber_view{ fib_main } ]() mutable {
+					auto expected = connect_pending;
+					if ( state->compare_exchange_strong( expected, connect_timed_out ) )
+						fib.resume();
+				}, opt.conn_timeout );
+				while ( true ) {
+					pollfd poll = { .fd = fd, .events = POLLOUT, .revents = 0 };
+					if ( auto err = socket_poll( poll, 0ms ) ) {
+						state->store( connect_settled );
+						co_return this->raise_error( XSTD_ESTR( "poll error: %d" ), err );
+					}
+					if ( stopped() ) {
+						state->store( connect_settled );
+						co_return;
+					}
+					if ( poll.revents & ( POLLERR | POLLHUP ) ) {
+						state->store( connect_settled );
+						co_return this->raise_error( XSTD_ESTR( "socket error: %d" ), get_socket_error() );
+					}
+
+					// Settle the state on completion, if the timer got there first the connection has timed out.
+					//
+					auto expected = connect_pending;
+					if ( ( poll.revents & POLLOUT ) && state->compare_exchange_strong( expected, connect_settled ) ) {
+						break;
+					} else if ( state->load() == connect_timed_out ) {
+						stop( stream_stop_timeout, XSTD_ESTR( "connection timed out" ) );
+						co_return;
+					}
+					co_yield {};
+				}
+			}
+
+			// Hand over to the data fibers.
+			//
+			connected.store( true, std::memory_order::release );
+			fib_receiver.resume();
+			fib_sender.resume();
+		}
+#endif
+#if !XSTD_WINSOCK
+		bool zerocopy = false;
+		fiber send_more() {
+			auto         ctrl =         this->controller();
+			send_queue   queue =        {};
+			const size_t zc_threshold = zerocopy ? opt.zerocopy_threshold : 0;
+
+			// Enter the loop once socket is ready.
+			//
+			co_yield {};
+			while ( true ) {
+				// Release the buffers the kernel is done with.
+				//
+				if ( zc_threshold ) this->socket_reap_zerocopy( queue );
+
+				// If there's nothing pending, wait for the user to request a send.
+				//
+				if ( queue.pending.empty() ) {
+					auto data = co_await ctrl.read();
+					if ( data.empty() ) {
+						while ( !queue.inflight.empty() && !stopped() ) {
+							co_yield {};
+							this->socket_reap_zerocopy( queue );
+						}
+						if ( ctrl.is_shutting_down() ) {
+							this->socket_shutdown( false, true );
+						}
+						co_return;
+					}
+					queue.push( std::move( data ) );
+				}
+
+				// Take whatever else was written in the meantime without waiting.
+				//
+				while ( queue.pending_bytes < opt.sendbuf ) {
+					auto data = ctrl.read().now();
+					if ( data.empty() ) break;
+					queue.push( std::move( data ) );
+				}
+
+				// Ask the socket to write the data, wait if the socket is full or if there's too much in-flight.
+				//
+				bool need_poll = this->socket_send( queue, zc_threshold );
+				if ( stopped() ) co_return;
+				if ( need_poll || queue.inflight_bytes > opt.sendbuf ) co_yield {};
+			}
+		}
+#else
 		fiber send_more() {
 			// Allocate the buffer and get the controller.
 			//
@@ -746,6 +1687,7 @@ namespace xstd::net {
 				}
 			}
 		}
+#endif
 		fiber recv_more() {
 			// Allocate the buffer and get the controller.
 			//
@@ -875,6 +1817,31 @@ namespace xstd::net {
 				return;
 			set_fd( listen_socket );
 
+#if XSTD_EPOLL
+			// If sharding, create the rest of the listeners, the kernel will balance the connections between them.
+			//
+			size_t shard_count = opt.listen_shards ? opt.listen_shards : std::max( 1u, std::thread::hardware_concurrency() );
+			listeners.emplace_back( std::make_unique<listener>( fd ) );
+			if ( shard_count > 1 ) {
+				if ( !this->assert_status( XSTD_ESTR( "failed to set reuseport: %d" ), this->set_socket_opt( SOL_SOCKET, SO_REUSEPORT, 1 ) ) )
+					return;
+				for ( size_t n = 1; n != shard_count; n++ ) {
+					socket_t shard = invalid_socket;
+					if ( !this->assert_status( XSTD_ESTR( "failed to create a socket: %d" ), detail::create_socket( &shard, AF_INET, SOCK_STREAM ) ) )
+						return;
+					listeners.emplace_back( std::make_unique<listener>( shard ) );
+
+					int one = 1;
+					if ( !this->assert_status( XSTD_ESTR( "failed to set reuseaddr: %d" ), this->set_socket_opt( shard, SOL_SOCKET, SO_REUSEADDR, &one, sizeof( one ) ) ) )
+						return;
+					if ( !this->assert_status( XSTD_ESTR( "failed to set reuseport: %d" ), this->set_socket_opt( shard, SOL_SOCKET, SO_REUSEPORT, &one, sizeof( one ) ) ) )
+						return;
+					if ( !this->assert_status( XSTD_ESTR( "failed to bind socket: %d" ), this->socket_bind( shard ) ) )
+						return;
+				}
+			}
+#endif
+
 			// Bind the socket.
 			//
 			if ( !this->assert_status( XSTD_ESTR( "failed to bind socket: %d" ), this->socket_bind() ) )
@@ -882,31 +1849,119 @@ namespace xstd::net {
 		}
 		tcp_server( uint16_t port, socket_options opts = {} ) : tcp_server( ipv4{}, port, opts ) {}
 
+		// Starts accepting connections, callback may be invoked concurrently if there are multiple listeners.
+		//
 		template<typename F>
 		bool listen( F&& callback ) {
+#if XSTD_EPOLL
+			auto cb = std::make_shared<std::decay_t<F>>( std::forward<F>( callback ) );
+			for ( auto& l : listeners ) {
+				if ( !this->assert_status( XSTD_ESTR( "failed to listen socket: %d" ), this->socket_listen( l->fd ) ) )
+					return false;
+				if ( !this->assert_status( XSTD_ESTR( "failed to change socket mode: %d" ), detail::set_blocking( l->fd, false ) ) )
+					return false;
+				l->fib = accept_reactor( *l, cb );
+				if ( !this->assert_status( XSTD_ESTR( "failed to register socket: %d" ), reactor::get( l->fd ).attach( l->entry, l->fd, l.get(), &listener::on_ready, EPOLLIN | EPOLLET ) ) )
+					return false;
+				l->fib.resume();
+			}
+#else
 			if ( !this->assert_status( XSTD_ESTR( "failed to listen socket: %d" ), this->socket_listen() ) )
 				return false;
+			if ( !this->assert_status( XSTD_ESTR( "failed to change socket mode: %d" ), detail::set_blocking( fd, false ) ) )
+				return false;
 			fib_accept = accept_more( std::forward<F>( callback ) );
+#endif
 			return true;
 		}
 
 		~tcp_server() {
+#if XSTD_EPOLL
+			for ( auto& l : listeners ) {
+				if ( l->entry )
+					reactor::get( l->fd ).detach( l->entry );
+				l->fib.destroy();
+				if ( l->fd != fd )
+					detail::close_socket( l->fd );
+			}
+#endif
 			close();
 			stop( stream_stop_killed, XSTD_ESTR( "dropped" ) );
 		}
 
 	protected:
+		// Drains the backlog of a listener, returns false if the error is fatal, sets backoff if we ran out of resources.
+		//
+		template<typename F>
+		bool accept_all( socket_t sock, F& callback, bool& backoff ) {
+			while ( !stopped() ) {
+				auto [client, ip, port] = this->socket_accept( sock );
+				if ( client == invalid_socket ) {
+					auto err = detail::get_last_error( -1 );
+#if XSTD_WINSOCK
+					if ( err == WSAEWOULDBLOCK || err == WSAECONNRESET || err == WSAEINTR )
+						return true;
+#else
+					if ( err == EAGAIN || err == EWOULDBLOCK )
+						return true;
+					if ( err == EMFILE || err == ENFILE || err == ENOBUFS || err == ENOMEM )
+						return backoff = true;
+					if ( err == EINTR || err == ECONNABORTED || err == EPROTO )
+						continue;
+#endif
+					raise_error( XSTD_ESTR( "socket error: %d" ), err );
+					return false;
+				}
+				callback( std::make_unique<tcp>( ip, port, opt, client ) );
+			}
+			return false;
+		}
+
+#if XSTD_EPOLL
+		// Listener state, each one is registered to the reactor and drained by its own fiber.
+		//
+		struct listener {
+			socket_t        fd;
+			reactor::entry* entry = nullptr;
+			fiber           fib = {};
+
+			listener( socket_t fd ) : fd( fd ) {}
+
+			static void on_ready( void* ctx, uint32_t ) {
+				( (listener*) ctx )->fib.resume();
+			}
+		};
+		std::vector<std::unique_ptr<listener>> listeners;
+
+		template<typename F>
+		fiber accept_reactor( listener& l, std::shared_ptr<F> callback ) {
+			while ( true ) {
+				co_yield {};
+				bool backoff = false;
+				if ( !accept_all( l.fd, *callback, backoff ) )
+					co_return;
+
+				// If we stopped due to running out of descriptors, the edge won't fire again until the next connection, retry after a stall.
+				//
+				if ( backoff ) {
+					xstd::chore( [ fib = fiber_view{ l.fib } ]() mutable { fib.resume(); }, opt.max_stall );
+				}
+			}
+		}
+#endif
+
 		template<typename F>
 		fiber accept_more( F callback ) {
 			// Create FD watch.
 			//
-			fd_set fd_er, fd_wr;
+			fd_set fd_er, fd_rd;
 			while ( true ) {
-				FD_ZERO( &fd_er );    FD_ZERO( &fd_wr );
-				FD_SET( fd, &fd_er ); FD_SET( fd, &fd_wr );
+				co_await yield{};
+				FD_ZERO( &fd_er );    FD_ZERO( &fd_rd );
+				FD_SET( fd, &fd_er ); FD_SET( fd, &fd_rd );
 
 				timeval stall_timeout = detail::to_timeval( opt.max_stall );
-				if ( select( int( fd ) + 1, &fd_wr, &fd_wr, &fd_er, &stall_timeout ) < 0 ) {
+				if ( select( int( fd ) + 1, &fd_rd, nullptr, &fd_er, &stall_timeout ) < 0 ) {
 					this->stop( stream_stop_timeout, XSTD_ESTR( "accept wait error" ) );
 					co_return;
 				}
@@ -918,15 +1973,10 @@ namespace xstd::net {
 					co_return raise_error( XSTD_ESTR( "socket error: %d" ), get_socket_error() );
 				}
 
-				if ( FD_ISSET( fd, &fd_wr ) ) {
-					auto [sock, ip, port] = this->socket_accept();
-					if ( !sock ) {
-						if ( auto err = get_socket_error() ) {
-							co_return raise_error( XSTD_ESTR( "socket error: %d" ), get_socket_error() );
-						}
-					} else {
-						callback( std::make_unique<tcp>( ip, port, opt, sock ) );
-					}
+				if ( FD_ISSET( fd, &fd_rd ) ) {
+					bool backoff = false;
+					if ( !accept_all( fd, callback, backoff ) )
+						co_return;
 				}
 			}
 		}
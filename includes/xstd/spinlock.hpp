@@ -3,10 +3,25 @@
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
+#include <optional>
+#include <climits>
 #include "intrinsics.hpp"
 #include "bitwise.hpp"
 #include "assert.hpp"
 
+#if USER_TARGET && defined(__linux__)
+	#include <unistd.h>
+	#include <sys/syscall.h>
+	#include <linux/futex.h>
+#endif
+
+// [[Configuration]]
+// XSTD_ADAPTIVE_SPIN_LIMIT: Upper bound of the self-tuned number of spins adaptive locks perform before parking.
+//
+#ifndef XSTD_ADAPTIVE_SPIN_LIMIT
+	#define XSTD_ADAPTIVE_SPIN_LIMIT 256
+#endif
+
 namespace xstd
 {
 	template<typename T>
@@ -247,6 +262,365 @@ namespace xstd
 		}
 	};
 
+	// Parking primitives for the adaptive locks, futex on Linux, atomic waits on other user-mode targets and spinning otherwise.
+	//
+	namespace impl {
+		FORCE_INLINE inline void park( std::atomic<uint32_t>& word, uint32_t expected ) {
+#if USER_TARGET && defined(__linux__)
+			syscall( SYS_futex, (uint32_t*) &word, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0 );
+#elif USER_TARGET
+			word.wait( expected, std::memory_order::relaxed );
+#else
+			yield_cpu();
+#endif
+		}
+		FORCE_INLINE inline void unpark( std::atomic<uint32_t>& word, bool all ) {
+#if USER_TARGET && defined(__linux__)
+			syscall( SYS_futex, (uint32_t*) &word, FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, nullptr, nullptr, 0 );
+#elif USER_TARGET
+			if ( all ) word.notify_all();
+			else       word.notify_one();
+#endif
+		}
+
+		// Self-tuned spin budget, moves the estimate towards the number of spins the last acquisition took or towards zero
+		// if spinning did not help, in which case the owner was most likely descheduled.
+		//
+		FORCE_INLINE inline int32_t spin_limit( int32_t estimate ) {
+			return std::min<int32_t>( XSTD_ADAPTIVE_SPIN_LIMIT, estimate * 2 + 16 );
+		}
+		FORCE_INLINE inline void update_spin_estimate( std::atomic<uint16_t>& estimate, int32_t prev, int32_t spins ) {
+			estimate.store( uint16_t( prev + ( spins - prev ) / 8 ), std::memory_order::relaxed );
+		}
+		inline constexpr auto no_tpr = [ ] () {};
+	};
+
+	// Contention counters of the adaptive locks.
+	//
+	struct lock_counters {
+		std::atomic<uint32_t> contended = 0; // Acquisitions that failed the fast path.
+		std::atomic<uint32_t> parked =    0; // Acquisitions that had to park after spinning.
+		std::atomic<uint32_t> handoffs =  0; // Releases that handed the lock directly to a parked waiter.
+
+		void reset() {
+			contended.store( 0, std::memory_order::relaxed );
+			parked.store( 0, std::memory_order::relaxed );
+			handoffs.store( 0, std::memory_order::relaxed );
+		}
+	};
+
+	// Adaptive lock, spins for a self-tuned number of iterations before parking.
+	// - If fair, releasing with parked waiters hands the ownership over to one instead of letting new threads barge in.
+	//
+	template<bool Fair = false>
+	struct basic_adaptive_lock {
+		static constexpr uint32_t locked_bit =  1;
+		static constexpr uint32_t handoff_bit = 2;
+		static constexpr uint32_t waiter_one =  4;
+
+		std::atomic<uint32_t> value =         0;
+		std::atomic<uint16_t> spin_estimate = 0;
+		lock_counters         counters =      {};
+
+		FORCE_INLINE bool try_lock() {
+			uint32_t v = value.load( std::memory_order::relaxed );
+			return !( v & locked_bit ) && value.compare_exchange_strong( v, v | locked_bit, std::memory_order::acquire );
+		}
+		FORCE_INLINE void unlock() {
+			dassert( locked() );
+			if constexpr ( Fair ) {
+				uint32_t v = locked_bit;
+				if ( !value.compare_exchange_strong( v, 0, std::memory_order::release ) ) [[unlikely]]
+					unlock_slow();
+			} else {
+				if ( value.fetch_sub( locked_bit, std::memory_order::release ) >= waiter_one ) [[unlikely]]
+					impl::unpark( value, false );
+			}
+		}
+		FORCE_INLINE bool locked() const {
+			return value.load( std::memory_order::relaxed ) & locked_bit;
+		}
+		FORCE_INLINE void lock() {
+			if ( !try_lock() ) [[unlikely]]
+				lock_slow();
+		}
+
+		// Slow paths, raise/lower are invoked around every acquisition attempt.
+		//
+		template<typename Raise = decltype( impl::no_tpr ), typename Lower = decltype( impl::no_tpr )>
+		NO_INLINE void lock_slow( Raise&& raise = {}, Lower&& lower = {} ) {
+			counters.contended.fetch_add( 1, std::memory_order::relaxed );
+
+			// Spin for about as long as the owner held the lock recently.
+			//
+			int32_t estimate = spin_estimate.load( std::memory_order::relaxed );
+			int32_t limit =    impl::spin_limit( estimate );
+			for ( int32_t n = 0; n != limit; n++ ) {
+				yield_cpu();
+				uint32_t v = value.load( std::memory_order::relaxed );
+				if ( !( v & locked_bit ) ) {
+					raise();
+					if ( value.compare_exchange_strong( v, v | locked_bit, std::memory_order::acquire ) ) {
+						impl::update_spin_estimate( spin_estimate, estimate, n );
+						return;
+					}
+					lower();
+				}
+			}
+			impl::update_spin_estimate( spin_estimate, estimate, 0 );
+
+			// Register as a waiter and park until the lock is released or handed off.
+			//
+			counters.parked.fetch_add( 1, std::memory_order::relaxed );
+			uint32_t v = value.fetch_add( waiter_one, std::memory_order::relaxed ) + waiter_one;
+			while ( true ) {
+				if ( v & handoff_bit ) {
+					raise();
+					if ( value.compare_exchange_weak( v, v - handoff_bit - waiter_one, std::memory_order::acquire ) )
+						return;
+					lower();
+				} else if ( !( v & locked_bit ) ) {
+					raise();
+					if ( value.compare_exchange_weak( v, ( v | locked_bit ) - waiter_one, std::memory_order::acquire ) )
+						return;
+					lower();
+				} else {
+					impl::park( value, v );
+					v = value.load( std::memory_order::relaxed );
+				}
+			}
+		}
+		NO_INLINE void unlock_slow() {
+			uint32_t v = value.load( std::memory_order::relaxed );
+			while ( true ) {
+				if ( v < waiter_one ) {
+					if ( value.compare_exchange_weak( v, v & ~locked_bit, std::memory_order::release ) )
+						return;
+				} else if ( value.compare_exchange_weak( v, v | handoff_bit, std::memory_order::release ) ) {
+					counters.handoffs.fetch_add( 1, std::memory_order::relaxed );
+					return impl::unpark( value, false );
+				}
+			}
+		}
+	};
+	using adaptive_lock =      basic_adaptive_lock<false>;
+	using fair_adaptive_lock = basic_adaptive_lock<true>;
+
+	// - Task priority wrapper.
+	//
+	template<task_priority_t Tpr = XSTD_SYNC_TPR, bool Fair = false>
+	struct xadaptive_lock : protected basic_adaptive_lock<Fair> {
+		using underlying_lock = basic_adaptive_lock<Fair>;
+		static constexpr task_priority_t task_priority = Tpr;
+
+		FORCE_INLINE underlying_lock& unwrap() { return *this; }
+		FORCE_INLINE const underlying_lock& unwrap() const { return *this; }
+		FORCE_INLINE const lock_counters& counters() const { return underlying_lock::counters; }
+
+		FORCE_INLINE bool try_lock( task_priority_t prev ) {
+			set_task_priority( Tpr );
+			if ( underlying_lock::try_lock() ) return true;
+			set_task_priority( prev );
+			return false;
+		}
+		FORCE_INLINE void unlock( task_priority_t prev ) {
+			underlying_lock::unlock();
+			set_task_priority( prev );
+		}
+		FORCE_INLINE bool locked() const {
+			return underlying_lock::locked();
+		}
+		FORCE_INLINE void lock( task_priority_t prev ) {
+			if ( !try_lock( prev ) ) [[unlikely]]
+				underlying_lock::lock_slow( [ ] { set_task_priority( Tpr ); }, [ prev ] { set_task_priority( prev ); } );
+		}
+	};
+
+	// Adaptive shared lock, 0xFFFF in the low half marks unique ownership and bit 16 marks parked waiters.
+	//
+	struct shared_adaptive_lock {
+		static constexpr uint32_t count_mask = 0xFFFF;
+		static constexpr uint32_t unique =     0xFFFF;
+		static constexpr uint32_t waiter_bit = 0x10000;
+
+		std::atomic<uint32_t> value =         0;
+		std::atomic<uint16_t> spin_estimate = 0;
+		lock_counters         counters =      {};
+
+		FORCE_INLINE static std::optional<uint32_t> next_unique( uint32_t v ) {
+			if ( v & count_mask ) return std::nullopt;
+			return v | unique;
+		}
+		FORCE_INLINE static std::optional<uint32_t> next_shared( uint32_t v ) {
+			if ( ( v & count_mask ) >= ( unique - 1 ) ) return std::nullopt;
+			return v + 1;
+		}
+
+		FORCE_INLINE bool try_lock() {
+			uint32_t v = value.load( std::memory_order::relaxed );
+			return !( v & count_mask ) && value.compare_exchange_strong( v, v | unique, std::memory_order::acquire );
+		}
+		FORCE_INLINE bool try_upgrade() {
+			uint32_t v = value.load( std::memory_order::relaxed );
+			return ( v & count_mask ) == 1 && value.compare_exchange_strong( v, ( v & waiter_bit ) | unique, std::memory_order::acquire );
+		}
+		FORCE_INLINE bool try_lock_shared() {
+			uint32_t v = value.load( std::memory_order::relaxed );
+			while ( ( v & count_mask ) < ( unique - 1 ) ) [[likely]] {
+				if ( value.compare_exchange_strong( v, v + 1, std::memory_order::acquire ) ) [[likely]]
+					return true;
+			}
+			return false;
+		}
+		FORCE_INLINE void downgrade() {
+			dassert( locked_unique() );
+			if ( value.exchange( 1, std::memory_order::release ) & waiter_bit ) [[unlikely]]
+				impl::unpark( value, true );
+		}
+		FORCE_INLINE void unlock() {
+			dassert( locked_unique() );
+			if ( value.exchange( 0, std::memory_order::release ) & waiter_bit ) [[unlikely]]
+				impl::unpark( value, true );
+		}
+		FORCE_INLINE void unlock_shared() {
+			uint32_t prev = value.fetch_sub( 1, std::memory_order::release );
+			dassert( 0 < ( prev & count_mask ) && ( prev & count_mask ) < unique );
+			if ( ( prev & ( count_mask | waiter_bit ) ) == ( waiter_bit | 1 ) ) [[unlikely]] {
+				value.fetch_and( ~waiter_bit, std::memory_order::relaxed );
+				impl::unpark( value, true );
+			}
+		}
+		FORCE_INLINE bool locked() const {
+			return value.load( std::memory_order::relaxed ) & count_mask;
+		}
+		FORCE_INLINE bool locked_unique() const {
+			return ( value.load( std::memory_order::relaxed ) & count_mask ) == unique;
+		}
+		FORCE_INLINE void lock() {
+			if ( !try_lock() ) [[unlikely]]
+				lock_slow( &next_unique );
+		}
+		FORCE_INLINE void lock_shared() {
+			if ( !try_lock_shared() ) [[unlikely]]
+				lock_slow( &next_shared );
+		}
+		FORCE_INLINE void upgrade() {
+			if ( !try_upgrade() ) {
+				unlock_shared();
+				lock();
+			}
+		}
+
+		// Slow path, next returns the value after acquisition if the state permits it, raise/lower are invoked around every acquisition attempt.
+		//
+		template<typename Raise = decltype( impl::no_tpr ), typename Lower = decltype( impl::no_tpr )>
+		NO_INLINE void lock_slow( std::optional<uint32_t>( *next )( uint32_t ), Raise&& raise = {}, Lower&& lower = {} ) {
+			counters.contended.fetch_add( 1, std::memory_order::relaxed );
+
+			// Spin for about as long as the lock was held recently.
+			//
+			int32_t estimate = spin_estimate.load( std::memory_order::relaxed );
+			int32_t limit =    impl::spin_limit( estimate );
+			for ( int32_t n = 0; n != limit; n++ ) {
+				yield_cpu();
+				uint32_t v = value.load( std::memory_order::relaxed );
+				if ( auto nv = next( v ) ) {
+					raise();
+					if ( value.compare_exchange_strong( v, *nv, std::memory_order::acquire ) ) {
+						impl::update_spin_estimate( spin_estimate, estimate, n );
+						return;
+					}
+					lower();
+				}
+			}
+			impl::update_spin_estimate( spin_estimate, estimate, 0 );
+
+			// Mark the waiter bit and park until any release.
+			//
+			counters.parked.fetch_add( 1, std::memory_order::relaxed );
+			uint32_t v = value.load( std::memory_order::relaxed );
+			while ( true ) {
+				if ( auto nv = next( v ) ) {
+					raise();
+					if ( value.compare_exchange_weak( v, *nv, std::memory_order::acquire ) )
+						return;
+					lower();
+				} else if ( ( v & waiter_bit ) || value.compare_exchange_weak( v, v | waiter_bit, std::memory_order::relaxed ) ) {
+					impl::park( value, v | waiter_bit );
+					v = value.load( std::memory_order::relaxed );
+				}
+			}
+		}
+	};
+
+	// - Task priority wrapper.
+	//
+	template<task_priority_t Tpr = XSTD_SYNC_TPR>
+	struct shared_xadaptive_lock : protected shared_adaptive_lock {
+		using underlying_lock = shared_adaptive_lock;
+		static constexpr task_priority_t task_priority = Tpr;
+
+		FORCE_INLINE underlying_lock& unwrap() { return *this; }
+		FORCE_INLINE const underlying_lock& unwrap() const { return *this; }
+		FORCE_INLINE const lock_counters& counters() const { return underlying_lock::counters; }
+
+		FORCE_INLINE bool try_lock( task_priority_t prev ) {
+			set_task_priority( Tpr );
+			if ( underlying_lock::try_lock() ) return true;
+			set_task_priority( prev );
+			return false;
+		}
+		FORCE_INLINE bool try_lock_shared( task_priority_t prev ) {
+			set_task_priority( Tpr );
+			if ( underlying_lock::try_lock_shared() ) return true;
+			set_task_priority( prev );
+			return false;
+		}
+
+		FORCE_INLINE void unlock( task_priority_t prev ) {
+			underlying_lock::unlock();
+			set_task_priority( prev );
+		}
+		FORCE_INLINE void unlock_shared( task_priority_t prev ) {
+			underlying_lock::unlock_shared();
+			set_task_priority( prev );
+		}
+
+		FORCE_INLINE bool locked() const {
+			return underlying_lock::locked();
+		}
+		FORCE_INLINE bool locked_unique() const {
+			return underlying_lock::locked_unique();
+		}
+		FORCE_INLINE bool try_upgrade() {
+			return underlying_lock::try_upgrade();
+		}
+
+		FORCE_INLINE void lock( task_priority_t prev ) {
+			if ( !try_lock( prev ) ) [[unlikely]]
+				underlying_lock::lock_slow( &next_unique, [ ] { set_task_priority( Tpr ); }, [ prev ] { set_task_priority( prev ); } );
+		}
+		FORCE_INLINE void lock_shared( task_priority_t prev ) {
+			if ( !try_lock_shared( prev ) ) [[unlikely]]
+				underlying_lock::lock_slow( &next_shared, [ ] { set_task_priority( Tpr ); }, [ prev ] { set_task_priority( prev ); } );
+		}
+		FORCE_INLINE void upgrade() {
+			if ( !try_upgrade() ) {
+				underlying_lock::unlock_shared();
+				underlying_lock::lock();
+			}
+		}
+		FORCE_INLINE void upgrade( task_priority_t prev ) {
+			if ( !try_upgrade() ) {
+				unlock_shared( prev );
+				lock( prev );
+			}
+		}
+		FORCE_INLINE void downgrade() {
+			underlying_lock::downgrade();
+		}
+	};
+
 	// Recursive spinlock.
 	//
 	namespace impl { inline constexpr auto get_tid = [ ] () { return get_thread_uid(); }; };
@@ -4,8 +4,9 @@
 #include "spinlock.hpp"
 #include "event.hpp"
 #include "time.hpp"
-#include <list>
 #include <deque>
+#include <vector>
+#include <algorithm>
 #include <thread>
 
 // [[Configuration]]
@@ -30,6 +31,13 @@ extern "C" {
 #endif
 #endif
 
+// [[Configuration]]
+// XSTD_WORK_STEALING: If set, default thread-pool will use per-worker work-stealing deques for the immediate queue.
+//
+#ifndef XSTD_WORK_STEALING
+	#define XSTD_WORK_STEALING 0
+#endif
+
 namespace xstd {
 	// Work item.
 	//
@@ -49,6 +57,7 @@ namespace xstd {
 			return evt && event_primitive::from_handle( evt ).peek();
 		}
 	};
+	struct stealing_work_item : work_item {};
 
 	// Worker type, allowing thread-pool to be customized.
 	//
@@ -62,6 +71,9 @@ namespace xstd {
 		static constexpr int32_t yield_per_acquire = 24;  // < 1ms re-scheduling hit
 #endif
 		static constexpr bool is_lazy = true;
+		static constexpr size_t local_queue_length = 1024;  // Must be a power of two.
+		static constexpr size_t max_stealing_workers = 256;
+		static constexpr int64_t event_poll_interval = 8'000'000; // Event-triggered deferred work is polled every 8ms.
 		static size_t get_ideal_worker_count() {
 			return std::clamp<size_t>( 2 * std::thread::hardware_concurrency(), 8, 32 );
 		}
@@ -80,6 +92,7 @@ namespace xstd {
 		// Worker hooks.
 		//
 		FORCE_INLINE void sleep( uint32_t milliseconds ) { std::this_thread::sleep_for( milliseconds * 1ms ); }
+		FORCE_INLINE void halt_for( uint32_t milliseconds ) { static_cast<Self*>( this )->sleep( milliseconds ); }
 		FORCE_INLINE void execute( work_item item ) { item(); }
 		FORCE_INLINE void after_drain() {}
 
@@ -94,6 +107,10 @@ namespace xstd {
 			event.wait();
 			return event.reset();
 		}
+		FORCE_INLINE void halt_for( uint32_t milliseconds ) {
+			event.wait_for( milliseconds );
+			return event.reset();
+		}
 		FORCE_INLINE void signal() {
 			event.notify();
 		}
@@ -241,16 +258,361 @@ namespace xstd {
 		}
 	};
 
+	// Work-stealing immediate queue type, each worker owns a Chase-Lev deque it pushes to and pops
+	// from without locking, idle workers steal from the others and external pushes go to a shared list.
+	//
+	template<typename Worker>
+	struct work_queue<stealing_work_item, Worker> {
+		static constexpr size_t local_length = Worker::local_queue_length;
+		static constexpr size_t max_workers =  Worker::max_stealing_workers;
+		static_assert( local_length && !( local_length & ( local_length - 1 ) ), "Local queue length must be a power of two." );
+
+		// Per-worker deque, only the owner can push/pop from the bottom, anyone can steal from the top.
+		//
+		struct local_queue {
+			struct slot {
+				std::atomic<void( * )( void* )> cb =  nullptr;
+				std::atomic<void*>              arg = nullptr;
+			};
+
+			alignas( 64 ) std::atomic<int64_t> top =    0;
+			alignas( 64 ) std::atomic<int64_t> bottom = 0;
+			std::atomic<bool>                  owned =  false;
+			slot                               slots[ local_length ] = {};
+
+			FORCE_INLINE bool empty() const {
+				return bottom.load( std::memory_order::acquire ) <= top.load( std::memory_order::acquire );
+			}
+			FORCE_INLINE void store( int64_t idx, work_item item ) {
+				auto& s = slots[ idx & ( local_length - 1 ) ];
+				s.cb.store( item.cb, std::memory_order::relaxed );
+				s.arg.store( item.arg, std::memory_order::relaxed );
+			}
+			FORCE_INLINE work_item load( int64_t idx ) const {
+				auto& s = slots[ idx & ( local_length - 1 ) ];
+				return { s.cb.load( std::memory_order::relaxed ), s.arg.load( std::memory_order::relaxed ) };
+			}
+
+			// Owner-side push/pop.
+			//
+			FORCE_INLINE bool push( work_item item ) {
+				int64_t b = bottom.load( std::memory_order::relaxed );
+				int64_t t = top.load( std::memory_order::acquire );
+				if ( ( b - t ) >= int64_t( local_length ) ) [[unlikely]]
+					return false;
+				store( b, item );
+				std::atomic_thread_fence( std::memory_order::release );
+				bottom.store( b + 1, std::memory_order::relaxed );
+				return true;
+			}
+			FORCE_INLINE bool pop( work_item& out ) {
+				int64_t b = bottom.load( std::memory_order::relaxed ) - 1;
+				bottom.store( b, std::memory_order::relaxed );
+				std::atomic_thread_fence( std::memory_order::seq_cst );
+				int64_t t = top.load( std::memory_order::relaxed );
+				if ( t > b ) {
+					bottom.store( b + 1, std::memory_order::relaxed );
+					return false;
+				}
+
+				out = load( b );
+				if ( t == b ) {
+					bool won = top.compare_exchange_strong( t, t + 1, std::memory_order::seq_cst, std::memory_order::relaxed );
+					bottom.store( b + 1, std::memory_order::relaxed );
+					return won;
+				}
+				return true;
+			}
+
+			// Thief-side steal.
+			//
+			FORCE_INLINE bool steal( work_item& out ) {
+				int64_t t = top.load( std::memory_order::acquire );
+				std::atomic_thread_fence( std::memory_order::seq_cst );
+				int64_t b = bottom.load( std::memory_order::acquire );
+				if ( t >= b )
+					return false;
+				out = load( t );
+				return top.compare_exchange_strong( t, t + 1, std::memory_order::seq_cst, std::memory_order::relaxed );
+			}
+		};
+
+		// Registered deques.
+		//
+		std::atomic<local_queue*> locals[ max_workers ] = {};
+		std::atomic<size_t>       num_locals =  0;
+
+		// Shared list for pushes from outside the workers and local overflow.
+		//
+		xspinlock<>               lock =      {};
+		std::deque<work_item>     list =      {};
+		std::atomic<bool>         is_empty =  true;
+
+		// Idle state, pressure is the number of workers searching for work.
+		//
+		Worker*                   idle_list = nullptr;
+		std::atomic<uint16_t>     pressure =  0;
+		std::atomic<uint16_t>     num_idle =  0;
+
+		// Current worker's deque.
+		//
+		inline static thread_local work_queue*  current_owner = nullptr;
+		inline static thread_local local_queue* current_local = nullptr;
+		inline static thread_local size_t       current_index = 0;
+
+		// No copy/move.
+		//
+		work_queue() = default;
+		work_queue( work_queue&& ) noexcept = delete;
+		work_queue( const work_queue& ) = delete;
+		work_queue& operator=( work_queue&& ) noexcept = delete;
+		work_queue& operator=( const work_queue& ) = delete;
+		~work_queue() {
+			for ( auto& e : locals )
+				delete e.load( std::memory_order::relaxed );
+		}
+
+		// Attaches the calling worker to a free deque, or detaches it.
+		//
+		COLD void attach() {
+			while ( true ) {
+				size_t n = num_locals.load( std::memory_order::acquire );
+				for ( size_t i = 0; i != n; i++ ) {
+					local_queue* q = locals[ i ].load( std::memory_order::acquire );
+					bool expected = false;
+					if ( q && q->owned.compare_exchange_strong( expected, true ) ) {
+						current_owner = this;
+						current_local = q;
+						current_index = i;
+						return;
+					}
+				}
+
+				fassert( n < max_workers );
+				local_queue* q = new local_queue{};
+				q->owned.store( true, std::memory_order::relaxed );
+				local_queue* expected = nullptr;
+				if ( locals[ n ].compare_exchange_strong( expected, q ) ) {
+					num_locals.compare_exchange_strong( n, n + 1 );
+					current_owner = this;
+					current_local = q;
+					current_index = n;
+					return;
+				}
+				num_locals.compare_exchange_strong( n, n + 1 );
+				delete q;
+			}
+		}
+		void detach() {
+			if ( current_owner == this ) {
+				current_local->owned.store( false, std::memory_order::release );
+				current_owner = nullptr;
+				current_local = nullptr;
+			}
+		}
+
+		// Gets the next worker to signal to increase pressure if 0.
+		//
+		FORCE_INLINE Worker* locked_wakeup_one() {
+			Worker* w = idle_list;
+			uint16_t expected = pressure.load( std::memory_order::relaxed );
+			if ( w && !expected ) [[unlikely]] {
+				++pressure; // Weakened, can be > 1 after execution, don't care.
+				--num_idle;
+				idle_list = w->next_idle;
+				return w;
+			}
+			return nullptr;
+		}
+
+		// Wakes up an idle worker if there is no one searching for work, lock-free if there are no idle workers.
+		//
+		FORCE_INLINE void notify_one() {
+			std::atomic_thread_fence( std::memory_order::seq_cst );
+			if ( !num_idle.load( std::memory_order::relaxed ) || pressure.load( std::memory_order::relaxed ) )
+				return;
+
+			Worker* w;
+			{
+				std::lock_guard _g{ lock };
+				w = locked_wakeup_one();
+			}
+			if ( w ) w->signal();
+		}
+
+		// Work acquisition helpers.
+		//
+		FORCE_INLINE bool try_pop_shared( work_item& out ) {
+			if ( is_empty.load( std::memory_order::relaxed ) )
+				return false;
+
+			std::lock_guard _g{ lock };
+			if ( list.empty() )
+				return false;
+			out = list.front();
+			list.pop_front();
+			if ( list.empty() )
+				is_empty.store( true, std::memory_order::relaxed );
+			return true;
+		}
+		FORCE_INLINE bool try_steal( work_item& out ) {
+			size_t n = num_locals.load( std::memory_order::acquire );
+			for ( size_t i = 1; i <= n; i++ ) {
+				local_queue* q = locals[ ( current_index + i ) % n ].load( std::memory_order::acquire );
+				if ( q && q != current_local && q->steal( out ) )
+					return true;
+			}
+			return false;
+		}
+		FORCE_INLINE bool has_work() const {
+			if ( !is_empty.load( std::memory_order::relaxed ) )
+				return true;
+			size_t n = num_locals.load( std::memory_order::acquire );
+			for ( size_t i = 0; i != n; i++ ) {
+				local_queue* q = locals[ i ].load( std::memory_order::acquire );
+				if ( q && !q->empty() )
+					return true;
+			}
+			return false;
+		}
+
+		// Drains the queue.
+		//
+		template<typename Immediate>
+		FORCE_INLINE void drain( Worker& worker, [[maybe_unused]] Immediate& ) {
+			if ( current_owner != this ) [[unlikely]]
+				attach();
+
+			// Pop from the local deque, if there's more work signal the others to come steal it.
+			//
+			work_item rw;
+			if ( current_local->pop( rw ) ) [[likely]] {
+				if ( worker.idle ) {
+					worker.idle = false;
+					--pressure;
+				}
+				if ( !current_local->empty() )
+					notify_one();
+				return worker.execute( rw );
+			}
+
+			// Increment pressure and enter the search loop.
+			//
+			if ( !worker.idle ) ++pressure;
+			worker.idle = false;
+			int32_t yields_left = Worker::yield_per_acquire;
+			while ( true ) {
+				// Try the shared list and then the other workers.
+				//
+				if ( try_pop_shared( rw ) || try_steal( rw ) ) {
+					--pressure;
+					if ( has_work() )
+						notify_one();
+					return worker.execute( rw );
+				}
+
+				// Yield until we tried too many times.
+				//
+				if ( --yields_left >= 0 ) {
+					yield_cpu();
+					continue;
+				}
+
+				// Insert into idle list and drop the pressure before checking one last time, paired with
+				// the fence in notify_one so that either we see the work or the pusher sees us idle.
+				//
+				{
+					std::lock_guard _g{ lock };
+					worker.next_idle = idle_list;
+					idle_list = &worker;
+					++num_idle;
+					--pressure;
+				}
+				std::atomic_thread_fence( std::memory_order::seq_cst );
+				if ( !has_work() ) {
+					worker.idle = true;
+					return worker.halt();
+				}
+
+				// Work arrived, remove ourselves from the idle list unless someone already woke us up.
+				//
+				bool woken = true;
+				{
+					std::lock_guard _g{ lock };
+					for ( Worker** it = &idle_list; *it; it = &( *it )->next_idle ) {
+						if ( *it == &worker ) {
+							*it = worker.next_idle;
+							--num_idle;
+							++pressure;
+							woken = false;
+							break;
+						}
+					}
+				}
+				if ( woken ) {
+					worker.idle = true;
+					return worker.halt();
+				}
+				yields_left = Worker::yield_per_acquire;
+			}
+		}
+
+		// Appends work to the queue, stays in the local deque if called from a worker.
+		//
+		FORCE_INLINE void push( void( * cb )( void* ), void* arg ) {
+			if ( current_owner == this && current_local->push( work_item{ cb, arg } ) ) [[likely]]
+				return notify_one();
+			return push_shared( cb, arg );
+		}
+		NO_INLINE void push_shared( void( * cb )( void* ), void* arg ) {
+			std::unique_lock g{ lock };
+			list.emplace_back( work_item{ cb, arg } );
+			is_empty.store( false, std::memory_order::relaxed );
+
+			// If there is no pressure, wakeup next idle worker.
+			//
+			if ( Worker* w = locked_wakeup_one() ) {
+				g.unlock();
+				w->signal();
+			}
+		}
+
+		// Wakes up all threads, used for stopping the thread pool.
+		//
+		void wakeup_all() {
+			Worker* w;
+			{
+				std::lock_guard _g{ lock };
+				w = idle_list;
+				idle_list = nullptr;
+				num_idle = 0;
+			}
+
+			while ( w ) {
+				++pressure;
+				std::exchange( w, w->next_idle )->signal();
+			}
+		}
+	};
+
 	// Deferred queue type (assumes only one worker is using it).
 	//
+	// Timed entries are kept in a min-heap indexed by the due time so the worker can sleep exactly until the next
+	// deadline, entries that can be triggered by an event are kept aside and polled at the worker's event interval.
+	//
 	template<typename Worker>
 	struct work_queue<deferred_work_item, Worker> {
-		static constexpr size_t max_locked_traversal = 32;
-		
-		xspinlock<>                   lock =      {};
-		std::list<deferred_work_item> list =      {};
-		Worker*                       idle =      nullptr;
-		uint32_t                      sleep_hint = 0;
+		struct due_after {
+			FORCE_INLINE bool operator()( const deferred_work_item& a, const deferred_work_item& b ) const { return a.timeout > b.timeout; }
+		};
+
+		xspinlock<>                     lock =      {};
+		std::vector<deferred_work_item> timers =    {};
+		std::vector<deferred_work_item> events =    {};
+		int64_t                         event_deadline = INT64_MAX; // Earliest timeout within events.
+		int64_t                         next_poll = 0;
+		int64_t                         wake_time = INT64_MAX;      // Time the idle worker will wake up at.
+		Worker*                         idle =      nullptr;
 
 		// Locking logic assuming proper TPR.
 		//
@@ -271,88 +633,93 @@ namespace xstd {
 
 		// Drains the queue.
 		//
-		FORCE_INLINE void drain( Worker& worker, work_queue<work_item, Worker>& immediate ) {
-			// Acquire the lock.
+		template<typename Immediate>
+		FORCE_INLINE void drain( Worker& worker, Immediate& immediate ) {
+			// Acquire the lock, clear the idle state.
 			//
 			lock_as_worker();
+			idle = nullptr;
 
 			// If there is no work to do:
 			//
-			if ( list.empty() ) [[unlikely]] {
+			if ( timers.empty() && events.empty() ) [[unlikely]] {
 				// Set as idle entry, unlock and halt.
 				//
 				idle = &worker;
+				wake_time = INT64_MAX;
 				unlock_as_worker();
 				return worker.halt();
 			}
 
-			std::list<deferred_work_item> ready_list = {};
-			auto split_ready_from = [ & ]( std::list<deferred_work_item>& other ) FORCE_INLINE {
-				int64_t current_time = Worker::timestamp( 0 );
-				for ( auto it = other.begin(); it != other.end(); ) {
-					if ( auto entry = it++; entry->is_ready( current_time ) ) {
-						ready_list.splice( ready_list.end(), other, entry );
+			// Pop every expired timer.
+			//
+			std::vector<work_item> ready_list = {};
+			int64_t current_time = Worker::timestamp( 0 );
+			while ( !timers.empty() && timers.front().timeout < current_time ) {
+				std::pop_heap( timers.begin(), timers.end(), due_after{} );
+				ready_list.emplace_back( timers.back() );
+				timers.pop_back();
+			}
+
+			// Poll the events if the interval has passed or if one of them timed out.
+			//
+			if ( !events.empty() && ( next_poll <= current_time || event_deadline < current_time ) ) {
+				event_deadline = INT64_MAX;
+				for ( size_t n = 0; n != events.size(); ) {
+					if ( events[ n ].is_ready( current_time ) ) {
+						ready_list.emplace_back( events[ n ] );
+						events[ n ] = events.back();
+						events.pop_back();
+					} else {
+						event_deadline = std::min( event_deadline, events[ n ].timeout );
+						n++;
 					}
 				}
-			};
+				next_poll = current_time + Worker::event_poll_interval;
+			}
 
-			// Separate the ready list, either via two-phase merge or full-scan.
+			// Unlock and insert all entries from the ready list into the immediate queue if there's anything to do.
 			//
-			if ( list.size() > max_locked_traversal ) [[unlikely]] {
-				// Swap the list with an empty one.
-				//
-				std::list<deferred_work_item> backlog = {};
-				list.swap( backlog );
-
-				// Filter out the ready list while unlocked.
-				//
+			if ( !ready_list.empty() ) {
 				unlock_as_worker();
-				split_ready_from( backlog );
-				lock_as_worker();
-
-				// If list has new entries, scan it, insert backlog at the end.
-				//
-				if ( !list.empty() ) {
-					split_ready_from( list );
-					list.splice( list.end(), backlog, backlog.begin(), backlog.end() );
-				} 
-				// Otherwise, swap the lists.
-				//
-				else {
-					list.swap( backlog );
+				for ( work_item e : ready_list ) {
+					immediate.push( e.cb, e.arg );
 				}
-			} else {
-				// Filter out the ready list inline.
-				//
-				split_ready_from( list );
+				return;
 			}
 
-			// Unlock and commit sleep if there's nothing to do.
+			// Otherwise sleep until the next deadline, or until a push with an earlier deadline signals us.
 			//
+			int64_t deadline = event_deadline;
+			if ( !timers.empty() ) deadline = std::min( deadline, timers.front().timeout );
+			if ( !events.empty() ) deadline = std::min( deadline, next_poll );
+			idle = &worker;
+			wake_time = deadline;
 			unlock_as_worker();
-			if ( ready_list.empty() ) {
-				sleep_hint |= 15;
-				sleep_hint <<= 1;
-				return worker.sleep( sleep_hint & 255 );
-			}
 
-			// Insert all entries from the ready list into the immediate queue and return.
-			//
-			for ( work_item e : ready_list ) {
-				immediate.push( e.cb, e.arg );
-			}
-			sleep_hint = 0;
+			int64_t delta_ms = ( deadline - current_time + ( 1ms / 1ns ) - 1 ) / ( 1ms / 1ns );
+			return worker.halt_for( uint32_t( std::clamp<int64_t>( delta_ms, 1, UINT32_MAX ) ) );
 		}
 
 		// Appends work to the queue.
 		//
 		NO_INLINE void push( void( * cb )( void* ), void* arg, int64_t timeout, event_handle evt ) {
 			std::unique_lock g{ lock };
-			list.emplace_front( deferred_work_item{ work_item{cb, arg}, evt, timeout } );
+			deferred_work_item item{ work_item{cb, arg}, evt, timeout };
+			if ( evt ) {
+				events.emplace_back( item );
+				event_deadline = std::min( event_deadline, timeout );
+				if ( events.size() == 1 )
+					next_poll = Worker::timestamp( Worker::event_poll_interval );
+				timeout = std::min( timeout, next_poll );
+			} else {
+				timers.emplace_back( item );
+				std::push_heap( timers.begin(), timers.end(), due_after{} );
+			}
 
-			// Wake up if idle.
+			// Wake up if idle and we're due earlier than the worker.
 			//
-			if ( Worker* w = idle ) {
+			if ( Worker* w = idle; w && timeout < wake_time ) {
 				idle = nullptr;
 				g.unlock();
 				w->signal();
@@ -374,11 +741,13 @@ namespace xstd {
 
 	// Thread-pool.
 	//
-	template<typename Worker = default_worker>
+	template<typename Worker = default_worker, bool WorkStealing = XSTD_WORK_STEALING>
 	struct thread_pool {
+		using immediate_work_item = std::conditional_t<WorkStealing, stealing_work_item, work_item>;
+
 		// Immediate and the deferred queue.
 		//
-		work_queue<work_item, Worker>          queue = {};
+		work_queue<immediate_work_item, Worker> queue = {};
 		work_queue<deferred_work_item, Worker> deferred_queue  = {};
 
 		// Thread pool state.
@@ -397,6 +766,8 @@ namespace xstd {
 				queue.drain( worker, this->queue );
 				worker.after_drain();
 			}
+			if constexpr ( requires { queue.detach(); } )
+				queue.detach();
 			this->num_threads--;
 		}
 		NO_INLINE static void aux_entry_point( void* ctx ) {
@@ -466,6 +837,6 @@ namespace xstd {
 		}
 	};
 
-	template<typename Worker = default_worker>
-	inline thread_pool<Worker> g_default_threadpool;
+	template<typename Worker = default_worker, bool WorkStealing = XSTD_WORK_STEALING>
+	inline thread_pool<Worker, WorkStealing> g_default_threadpool;
 };
\ No newline at end of file
@@ -65,6 +65,7 @@ namespace xstd
 	template<typename T> concept HasVirtualDestructor =                   std::has_virtual_destructor_v<T>;
 	template<typename T> concept TriviallyCopyable =                      std::is_trivially_copyable_v<T>;
 	template<typename T> concept TriviallyDestructable =                  std::is_trivially_destructible_v<T>;
+	template<typename T> concept UniquelyRepresented =                    std::has_unique_object_representations_v<T>;
 	template<typename B, typename T> concept HasBase =                    std::is_base_of_v<B, T>;
 	template<typename S, typename D> concept Convertible =                std::is_convertible_v<S, D>;
 	template<typename S, typename D> concept Assignable =                 std::is_assignable_v<S, D>;
@@ -837,8 +838,19 @@ namespace xstd
 	template<typename T>
 	FORCE_INLINE inline T load_misaligned( const void* p ) {
 #if GNU_COMPILER
-		struct wrapper { T value; } __attribute__( ( packed ) );
-		return ( (const wrapper*) p )->value;
+		// GCC ignores the packed attribute for non-POD fields such as xvec, copy those into a byte array instead.
+		//
+		if constexpr ( !std::is_trivial_v<T> || !std::is_standard_layout_v<T> )
+		{
+			std::array<char, sizeof( T )> bytes;
+			__builtin_memcpy( bytes.data(), p, sizeof( T ) );
+			return xstd::bit_cast<T>( bytes );
+		}
+		else
+		{
+			struct wrapper { T value; } __attribute__( ( packed ) );
+			return ( (const wrapper*) p )->value;
+		}
 #else
 		using wrapper = std::array<char, sizeof( T )>;
 		return xstd::bit_cast<T>( *(const wrapper*) p );
@@ -848,8 +860,15 @@ namespace xstd
 	template<typename T>
 	FORCE_INLINE inline void store_misaligned( void* p, T r ) {
 #if GNU_COMPILER
-		struct wrapper { T value; } __attribute__( ( packed ) );
-		( (wrapper*) p )->value = r;
+		if constexpr ( !std::is_trivial_v<T> || !std::is_standard_layout_v<T> )
+		{
+			__builtin_memcpy( p, &r, sizeof( T ) );
+		}
+		else
+		{
+			struct wrapper { T value; } __attribute__( ( packed ) );
+			( (wrapper*) p )->value = r;
+		}
 #else
 		using wrapper = std::array<char, sizeof( T )>;
 		*(wrapper*) p = xstd::bit_cast<wrapper>( r );
@@ -3,6 +3,7 @@
 #include "bitwise.hpp"
 #include "type_helpers.hpp"
 #include "xvector.hpp"
+#include "cpu_dispatch.hpp"
 
 namespace xstd
 {
@@ -297,6 +298,17 @@ namespace xstd
 		static constexpr size_t MinSIMDWidth = 8;
 		static constexpr size_t MaxSIMDWidth = XSTD_VECTOR_EXT ? XSTD_SIMD_WIDTH : 0;
 
+		// Invokes the functor with the SIMD width picked for the host given the input length in bytes.
+		//
+		template<typename F>
+		FORCE_INLINE inline decltype( auto ) utf_simd_dispatch( size_t length, F&& f )
+		{
+			if constexpr ( MaxSIMDWidth != 0 )
+				return simd_dispatch( f, length >= 32 );
+			else
+				return f( const_tag<size_t( 0 )>{} );
+		}
+
 		template<typename Char, typename Char2, bool CaseSensitive, bool ForEquality, size_t SIMDWidth> requires ( sizeof( Char ) <= sizeof( Char2 ) )
 		FORCE_INLINE inline std::optional<int> utf_ascii_cmp( const Char* v1, const Char2* v2, size_t limit, size_t& iterator )
 		{
@@ -683,7 +695,11 @@ namespace xstd
 		{
 			To* result;
 			if ( !std::is_constant_evaluated() )
-				result = impl::utf_convert<To, From, NoOutputConstraints, ToUpper || ToLower, impl::MaxSIMDWidth>( view.data(), view.data() + view.size(), output.data(), output.data() + output.size(), ToLower );
+			{
+				result = impl::utf_simd_dispatch( view.size() * sizeof( From ), [ & ] <auto W> ( const_tag<W> ) FORCE_INLINE {
+					return impl::utf_convert<To, From, NoOutputConstraints, ToUpper || ToLower, W>( view.data(), view.data() + view.size(), output.data(), output.data() + output.size(), ToLower );
+				} );
+			}
 			else
 				result = impl::utf_convert<To, From, NoOutputConstraints, ToUpper || ToLower, 0>( view.data(), view.data() + view.size(), output.data(), output.data() + output.size(), ToLower );
 			return result - output.data();
@@ -706,7 +722,11 @@ namespace xstd
 			std::basic_string_view<Char> v1{ a };
 			std::basic_string_view<Char2> v2{ b };
 			if ( !std::is_constant_evaluated() )
-				return impl::utf_compare<Char, Char2, CaseSensitive, ForEquality, impl::MaxSIMDWidth>( v1.data(), v1.data() + v1.size(), v2.data(), v2.data() + v2.size() );
+			{
+				return impl::utf_simd_dispatch( std::min( v1.size() * sizeof( Char ), v2.size() * sizeof( Char2 ) ), [ & ] <auto W> ( const_tag<W> ) FORCE_INLINE {
+					return impl::utf_compare<Char, Char2, CaseSensitive, ForEquality, W>( v1.data(), v1.data() + v1.size(), v2.data(), v2.data() + v2.size() );
+				} );
+			}
 			else
 				return impl::utf_compare<Char, Char2, CaseSensitive, ForEquality, 0>( v1.data(), v1.data() + v1.size(), v2.data(), v2.data() + v2.size() );
 		}
@@ -735,7 +755,11 @@ namespace xstd
 		else
 		{
 			if ( !std::is_constant_evaluated() )
-				return impl::utf_calc_length<To, From, impl::MaxSIMDWidth>( view.data(), view.data() + view.size() );
+			{
+				return impl::utf_simd_dispatch( view.size() * sizeof( From ), [ & ] <auto W> ( const_tag<W> ) FORCE_INLINE {
+					return impl::utf_calc_length<To, From, W>( view.data(), view.data() + view.size() );
+				} );
+			}
 			else
 				return impl::utf_calc_length<To, From, 0>( view.data(), view.data() + view.size() );
 		}
@@ -14,7 +14,8 @@ namespace xstd {
 		LockType lock;
 
 		~basic_wait_list() { 
-			this->signal_and_reset( chore_scheduler{}, true )();
+			if ( next_index > 0 || associated_event )
+				this->signal_and_reset( chore_scheduler{}, true )();
 		}
 
 		// Container details.
@@ -75,14 +76,12 @@ namespace xstd {
 			}
 
 			coroutine_handle<> transfer = nullptr;
-			for ( auto& e : inline_list ) {
+			for ( int32_t i = 0; i < count; i++ ) {
+				auto e = i < I ? inline_list[ i ] : alloc[ i - I ];
+				if ( !e ) continue;
 				if ( transfer ) sched( transfer )();
 				transfer =      e;
 			}
-			for ( int32_t i = I; i < count; i++ ) {
-				if ( transfer ) sched( transfer )();
-				transfer =      alloc[ i - I ];
-			}
 			if ( alloc )
 				free( alloc );
 
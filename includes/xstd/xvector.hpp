@@ -4,6 +4,7 @@
 #include <bit>
 #include <array>
 #include <span>
+#include <cstring>
 #include "bitwise.hpp"
 
 // [[Configuration]]
@@ -132,7 +133,7 @@ namespace xstd
 		{
 			if ( !std::is_constant_evaluated() )
 			{
-				return xvec( std::in_place_t{}, load_misaligned<native_vector<T, N>>( from ) );
+				return load( ( const void* ) from );
 			}
 			else
 			{
@@ -144,7 +145,11 @@ namespace xstd
 		}
 		FORCE_INLINE static xvec load( const void* from ) noexcept
 		{
-			return xvec( std::in_place_t{}, load_misaligned<native_vector<T, N>>( from ) );
+			// Copied straight into the storage so that no function returns the native vector by value.
+			//
+			xvec result{};
+			memcpy( &result._nat, from, sizeof( result._nat ) );
+			return result;
 		}
 
 		// Construction by broadcast.
@@ -7,6 +7,26 @@
 #include "intrinsics.hpp"
 #include "type_helpers.hpp"
 #include "hexdump.hpp"
+#include "cpu_dispatch.hpp"
+
+// [[Configuration]]
+// XSTD_XXH3_VECTOR: Determines the vector width in bits used by the XXH3 accumulator loop, 0 for scalar.
+//
+#ifndef XSTD_XXH3_VECTOR
+	#if AMD64_TARGET && defined( __AVX2__ )
+		#define XSTD_XXH3_VECTOR 256
+	#elif AMD64_TARGET || ( ARM64_TARGET && ( defined( __ARM_NEON ) || MS_COMPILER ) )
+		#define XSTD_XXH3_VECTOR 128
+	#else
+		#define XSTD_XXH3_VECTOR 0
+	#endif
+#endif
+
+#if XSTD_XXH3_VECTOR && AMD64_TARGET
+	#include <immintrin.h>
+#elif XSTD_XXH3_VECTOR && ARM64_TARGET
+	#include <arm_neon.h>
+#endif
 
 namespace xstd
 {
@@ -207,7 +227,7 @@ namespace xstd
 
 		// Skips to next block.
 		//
-		FORCE_INLINE constexpr void compress( const uint8_t* block ) {
+		FORCE_INLINE static constexpr std::array<U, 4> compress( std::array<U, 4> acc, const uint8_t* block ) {
 			std::array<U, 4> data;
 			if ( std::is_constant_evaluated() ) {
 				for ( U& v : data ) {
@@ -217,12 +237,12 @@ namespace xstd
 					v = n;
 				}
 			} else {
-				data = *( const std::array<U, 4>* ) block;
+				memcpy( &data, block, sizeof( data ) );
 			}
-			iv = traits::vec_round( iv, data );
+			return traits::vec_round( acc, data );
 		}
 		FORCE_INLINE constexpr void next_block() {
-			compress( leftover.data() );
+			iv = compress( iv, leftover.data() );
 		}
 
 		// Appends the given array of bytes into the hash value.
@@ -258,12 +278,16 @@ namespace xstd
 				if ( !n ) return;
 			}
 
-			// Add full blocks.
+			// Add full blocks, keeping the state local so it stays in registers.
 			//
-			while ( n >= leftover.size() ) {
-				compress( data );
-				n -=    leftover.size();
-				data += leftover.size();
+			if ( n >= leftover.size() ) {
+				auto acc = iv;
+				do {
+					acc =   compress( acc, data );
+					n -=    leftover.size();
+					data += leftover.size();
+				} while ( n >= leftover.size() );
+				iv = acc;
 			}
 
 			// Add the remainder.
@@ -312,15 +336,15 @@ namespace xstd
 		FORCE_INLINE constexpr value_type digest() const noexcept
 		{
 			if ( finalized() ) [[likely]]
-				return iv;
+				return iv[ 0 ];
 			auto clone{ *this };
 			return clone.digest();
 		}
 
 		// Explicit conversions.
 		//
-		constexpr uint32_t as32() const noexcept { return uint32_t( digest()[ 0 ] ); }
-		constexpr uint64_t as64() const noexcept { return uint64_t( digest()[ 0 ] ); }
+		constexpr uint32_t as32() const noexcept { return uint32_t( digest() ); }
+		constexpr uint64_t as64() const noexcept { return uint64_t( digest() ); }
 
 		// Implicit conversions.
 		//
@@ -342,6 +366,608 @@ namespace xstd
 	//
 	using xxhash32 = basic_xxhash<uint32_t>;
 	using xxhash64 = basic_xxhash<uint64_t>;
+
+	// XXH3 traits.
+	//
+	struct xxh3_traits {
+		using traits32 = xxhash_traits<uint32_t>;
+		using traits64 = xxhash_traits<uint64_t>;
+		static constexpr uint64_t prime_mx1 = 0x165667919E3779F9ULL;
+		static constexpr uint64_t prime_mx2 = 0x9FB21C651E98DF25ULL;
+
+		static constexpr size_t stripe_length =     64;
+		static constexpr size_t secret_length =     192;
+		static constexpr size_t secret_length_min = 136;
+		static constexpr size_t midsize_max =       240;
+		static constexpr size_t buffer_length =     256;
+		static constexpr size_t stripes_per_block = ( secret_length - stripe_length ) / 8;
+
+		using secret_type = std::array<uint8_t, secret_length>;
+		using acc_type =    std::array<uint64_t, 8>;
+
+		alignas( 64 ) static constexpr secret_type default_secret = {
+			0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+			0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+			0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+			0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+			0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+			0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+			0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+			0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+			0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+			0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+			0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+			0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+		};
+		static constexpr acc_type default_acc = {
+			traits32::prime_3, traits64::prime_1, traits64::prime_2, traits64::prime_3,
+			traits64::prime_4, traits32::prime_2, traits64::prime_5, traits32::prime_1
+		};
+
+		// Little-endian loads and stores that are valid in constant evaluation.
+		//
+		FORCE_INLINE static constexpr uint32_t read32( const uint8_t* p ) {
+			if ( std::is_constant_evaluated() ) {
+				uint32_t v = 0;
+				for ( size_t i = 0; i != 4; i++ )
+					v |= uint32_t( p[ i ] ) << ( 8 * i );
+				return v;
+			}
+			uint32_t v;
+			memcpy( &v, p, sizeof( v ) );
+			return v;
+		}
+		FORCE_INLINE static constexpr uint64_t read64( const uint8_t* p ) {
+			if ( std::is_constant_evaluated() ) {
+				uint64_t v = 0;
+				for ( size_t i = 0; i != 8; i++ )
+					v |= uint64_t( p[ i ] ) << ( 8 * i );
+				return v;
+			}
+			uint64_t v;
+			memcpy( &v, p, sizeof( v ) );
+			return v;
+		}
+		FORCE_INLINE static constexpr void write64( uint8_t* p, uint64_t v ) {
+			if ( std::is_constant_evaluated() ) {
+				for ( size_t i = 0; i != 8; i++ )
+					p[ i ] = uint8_t( v >> ( 8 * i ) );
+			} else {
+				memcpy( p, &v, sizeof( v ) );
+			}
+		}
+
+		// Mixing primitives.
+		//
+		FORCE_INLINE static constexpr uint64_t mul_fold( uint64_t a, uint64_t b ) {
+			uint64_t hi = 0;
+			uint64_t lo = umul128( a, b, &hi );
+			return lo ^ hi;
+		}
+		FORCE_INLINE static constexpr uint64_t avalanche( uint64_t h ) {
+			h ^= h >> 37;
+			h *= prime_mx1;
+			h ^= h >> 32;
+			return h;
+		}
+		FORCE_INLINE static constexpr uint64_t rrmxmx( uint64_t h, uint64_t len ) {
+			h ^= rotl( h, 49 ) ^ rotl( h, 24 );
+			h *= prime_mx2;
+			h ^= ( h >> 35 ) + len;
+			h *= prime_mx2;
+			return h ^ ( h >> 28 );
+		}
+		FORCE_INLINE static constexpr uint64_t mix16( const uint8_t* in, const uint8_t* secret, uint64_t seed ) {
+			return mul_fold( read64( in ) ^ ( read64( secret ) + seed ), read64( in + 8 ) ^ ( read64( secret + 8 ) - seed ) );
+		}
+		FORCE_INLINE static constexpr void mix32( uint64_t& lo, uint64_t& hi, const uint8_t* in1, const uint8_t* in2, const uint8_t* secret, uint64_t seed ) {
+			lo += mix16( in1, secret, seed );
+			lo ^= read64( in2 ) + read64( in2 + 8 );
+			hi += mix16( in2, secret + 16, seed );
+			hi ^= read64( in1 ) + read64( in1 + 8 );
+		}
+
+		// Seeded secret derivation, used only by inputs longer than the midsize limit.
+		//
+		FORCE_INLINE static constexpr secret_type derive_secret( uint64_t seed ) {
+			secret_type result = {};
+			for ( size_t i = 0; i != secret_length; i += 16 ) {
+				write64( &result[ i ],     read64( &default_secret[ i ] ) + seed );
+				write64( &result[ i + 8 ], read64( &default_secret[ i + 8 ] ) - seed );
+			}
+			return result;
+		}
+
+		// Hashes inputs up to the midsize limit in one shot, keys up to 128 bytes are inlined.
+		//
+		NO_INLINE static constexpr uint64_t hash_mid_64( const uint8_t* in, size_t len, uint64_t seed ) {
+			const uint8_t* secret = default_secret.data();
+			uint64_t acc = len * traits64::prime_1;
+			for ( size_t i = 0; i != 8; i++ )
+				acc += mix16( in + 16 * i, secret + 16 * i, seed );
+			uint64_t acc_end = mix16( in + len - 16, secret + secret_length_min - 17, seed );
+			acc = avalanche( acc );
+			for ( size_t i = 8; i != ( len / 16 ); i++ )
+				acc_end += mix16( in + 16 * i, secret + 16 * ( i - 8 ) + 3, seed );
+			return avalanche( acc + acc_end );
+		}
+		FORCE_INLINE static constexpr uint64_t hash_short_64( const uint8_t* in, size_t len, uint64_t seed ) {
+			const uint8_t* secret = default_secret.data();
+			if ( len <= 16 ) {
+				if ( len > 8 ) {
+					uint64_t lo = read64( in ) ^ ( ( read64( secret + 24 ) ^ read64( secret + 32 ) ) + seed );
+					uint64_t hi = read64( in + len - 8 ) ^ ( ( read64( secret + 40 ) ^ read64( secret + 48 ) ) - seed );
+					return avalanche( len + bswap( lo ) + hi + mul_fold( lo, hi ) );
+				} else if ( len >= 4 ) {
+					seed ^= uint64_t( bswap( uint32_t( seed ) ) ) << 32;
+					uint64_t in64 = read32( in + len - 4 ) + ( uint64_t( read32( in ) ) << 32 );
+					return rrmxmx( in64 ^ ( ( read64( secret + 8 ) ^ read64( secret + 16 ) ) - seed ), len );
+				} else if ( len ) {
+					uint32_t combined = ( uint32_t( in[ 0 ] ) << 16 ) | ( uint32_t( in[ len >> 1 ] ) << 24 ) | uint32_t( in[ len - 1 ] ) | ( uint32_t( len ) << 8 );
+					return traits64::avalanche( combined ^ ( uint64_t( read32( secret ) ^ read32( secret + 4 ) ) + seed ) );
+				} else {
+					return traits64::avalanche( seed ^ read64( secret + 56 ) ^ read64( secret + 64 ) );
+				}
+			}
+
+			if ( len > 128 )
+				return hash_mid_64( in, len, seed );
+
+			uint64_t acc = len * traits64::prime_1;
+			if ( len > 32 ) {
+				if ( len > 64 ) {
+					if ( len > 96 ) {
+						acc += mix16( in + 48, secret + 96, seed );
+						acc += mix16( in + len - 64, secret + 112, seed );
+					}
+					acc += mix16( in + 32, secret + 64, seed );
+					acc += mix16( in + len - 48, secret + 80, seed );
+				}
+				acc += mix16( in + 16, secret + 32, seed );
+				acc += mix16( in + len - 32, secret + 48, seed );
+			}
+			acc += mix16( in, secret, seed );
+			acc += mix16( in + len - 16, secret + 16, seed );
+			return avalanche( acc );
+		}
+		FORCE_INLINE static constexpr std::array<uint64_t, 2> finish_128( uint64_t lo, uint64_t hi, size_t len, uint64_t seed ) {
+			uint64_t rl = lo + hi;
+			uint64_t rh = lo * traits64::prime_1 + hi * traits64::prime_4 + ( len - seed ) * traits64::prime_2;
+			return { avalanche( rl ), 0 - avalanche( rh ) };
+		}
+		NO_INLINE static constexpr std::array<uint64_t, 2> hash_mid_128( const uint8_t* in, size_t len, uint64_t seed ) {
+			const uint8_t* secret = default_secret.data();
+			uint64_t lo = len * traits64::prime_1;
+			uint64_t hi = 0;
+			for ( size_t i = 32; i != 160; i += 32 )
+				mix32( lo, hi, in + i - 32, in + i - 16, secret + i - 32, seed );
+			lo = avalanche( lo );
+			hi = avalanche( hi );
+			for ( size_t i = 160; i <= len; i += 32 )
+				mix32( lo, hi, in + i - 32, in + i - 16, secret + 3 + i - 160, seed );
+			mix32( lo, hi, in + len - 16, in + len - 32, secret + secret_length_min - 17 - 16, 0 - seed );
+			return finish_128( lo, hi, len, seed );
+		}
+		FORCE_INLINE static constexpr std::array<uint64_t, 2> hash_short_128( const uint8_t* in, size_t len, uint64_t seed ) {
+			const uint8_t* secret = default_secret.data();
+			if ( len <= 16 ) {
+				if ( len > 8 ) {
+					uint64_t lo = read64( in );
+					uint64_t hi = read64( in + len - 8 );
+					uint64_t mh = 0;
+					uint64_t ml = umul128( lo ^ hi ^ ( ( read64( secret + 32 ) ^ read64( secret + 40 ) ) - seed ), traits64::prime_1, &mh );
+					ml += uint64_t( len - 1 ) << 54;
+					hi ^= ( read64( secret + 48 ) ^ read64( secret + 56 ) ) + seed;
+					mh += hi + uint64_t( uint32_t( hi ) ) * ( traits32::prime_2 - 1 );
+					ml ^= bswap( mh );
+					uint64_t rh = 0;
+					uint64_t rl = umul128( ml, traits64::prime_2, &rh );
+					rh += mh * traits64::prime_2;
+					return { avalanche( rl ), avalanche( rh ) };
+				} else if ( len >= 4 ) {
+					seed ^= uint64_t( bswap( uint32_t( seed ) ) ) << 32;
+					uint64_t in64 = read32( in ) + ( uint64_t( read32( in + len - 4 ) ) << 32 );
+					uint64_t mh = 0;
+					uint64_t ml = umul128( in64 ^ ( ( read64( secret + 16 ) ^ read64( secret + 24 ) ) + seed ), traits64::prime_1 + ( len << 2 ), &mh );
+					mh += ml << 1;
+					ml ^= mh >> 3;
+					ml ^= ml >> 35;
+					ml *= prime_mx2;
+					ml ^= ml >> 28;
+					return { ml, avalanche( mh ) };
+				} else if ( len ) {
+					uint32_t combined_lo = ( uint32_t( in[ 0 ] ) << 16 ) | ( uint32_t( in[ len >> 1 ] ) << 24 ) | uint32_t( in[ len - 1 ] ) | ( uint32_t( len ) << 8 );
+					uint32_t combined_hi = rotl( bswap( combined_lo ), 13 );
+					return {
+						traits64::avalanche( combined_lo ^ ( uint64_t( read32( secret ) ^ read32( secret + 4 ) ) + seed ) ),
+						traits64::avalanche( combined_hi ^ ( uint64_t( read32( secret + 8 ) ^ read32( secret + 12 ) ) - seed ) )
+					};
+				} else {
+					return {
+						traits64::avalanche( seed ^ read64( secret + 64 ) ^ read64( secret + 72 ) ),
+						traits64::avalanche( seed ^ read64( secret + 80 ) ^ read64( secret + 88 ) )
+					};
+				}
+			}
+
+			if ( len > 128 )
+				return hash_mid_128( in, len, seed );
+
+			uint64_t lo = len * traits64::prime_1;
+			uint64_t hi = 0;
+			if ( len > 32 ) {
+				if ( len > 64 ) {
+					if ( len > 96 )
+						mix32( lo, hi, in + 48, in + len - 64, secret + 96, seed );
+					mix32( lo, hi, in + 32, in + len - 48, secret + 64, seed );
+				}
+				mix32( lo, hi, in + 16, in + len - 32, secret + 32, seed );
+			}
+			mix32( lo, hi, in, in + len - 16, secret, seed );
+			return finish_128( lo, hi, len, seed );
+		}
+
+		// Long input accumulator, one 64-byte stripe against the secret at the given offset.
+		//
+		FORCE_INLINE static constexpr void accumulate_512( acc_type& acc, const uint8_t* in, const uint8_t* secret ) {
+			for ( size_t i = 0; i != 8; i++ ) {
+				uint64_t data = read64( in + 8 * i );
+				uint64_t key =  data ^ read64( secret + 8 * i );
+				acc[ i ^ 1 ] += data;
+				acc[ i ] +=     uint64_t( uint32_t( key ) ) * ( key >> 32 );
+			}
+		}
+#if XSTD_XXH3_VECTOR >= 256 || ( XSTD_XXH3_VECTOR >= 128 && AMD64_TARGET && XSTD_CPU_DISPATCH )
+	#if XSTD_XXH3_VECTOR >= 256
+		FORCE_INLINE static void accumulate_256( acc_type& acc, const uint8_t* in, const uint8_t* secret, size_t stripes ) {
+	#else
+		// Selected at runtime when the target lacks AVX2 but the host has it.
+		//
+		XSTD_TARGET_AVX2 NO_INLINE static void accumulate_256( acc_type& acc, const uint8_t* in, const uint8_t* secret, size_t stripes ) {
+	#endif
+			__m256i a0 = _mm256_loadu_si256( ( const __m256i* ) &acc[ 0 ] );
+			__m256i a1 = _mm256_loadu_si256( ( const __m256i* ) &acc[ 4 ] );
+			for ( ; stripes; stripes--, in += stripe_length, secret += 8 ) {
+				__m256i d0 = _mm256_loadu_si256( ( const __m256i* ) in );
+				__m256i d1 = _mm256_loadu_si256( ( const __m256i* ) ( in + 32 ) );
+				__m256i k0 = _mm256_xor_si256( d0, _mm256_loadu_si256( ( const __m256i* ) secret ) );
+				__m256i k1 = _mm256_xor_si256( d1, _mm256_loadu_si256( ( const __m256i* ) ( secret + 32 ) ) );
+				a0 = _mm256_add_epi64( a0, _mm256_shuffle_epi32( d0, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+				a1 = _mm256_add_epi64( a1, _mm256_shuffle_epi32( d1, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+				a0 = _mm256_add_epi64( a0, _mm256_mul_epu32( k0, _mm256_srli_epi64( k0, 32 ) ) );
+				a1 = _mm256_add_epi64( a1, _mm256_mul_epu32( k1, _mm256_srli_epi64( k1, 32 ) ) );
+			}
+			_mm256_storeu_si256( ( __m256i* ) &acc[ 0 ], a0 );
+			_mm256_storeu_si256( ( __m256i* ) &acc[ 4 ], a1 );
+		}
+#endif
+		FORCE_INLINE static void accumulate_vec( acc_type& acc, const uint8_t* in, const uint8_t* secret, size_t stripes ) {
+#if XSTD_XXH3_VECTOR >= 256
+			accumulate_256( acc, in, secret, stripes );
+#elif XSTD_XXH3_VECTOR >= 128 && AMD64_TARGET
+	#if XSTD_CPU_DISPATCH
+			if ( active_isa_level() >= isa_level::avx2 )
+				return accumulate_256( acc, in, secret, stripes );
+	#endif
+			__m128i a[ 4 ];
+			for ( size_t i = 0; i != 4; i++ )
+				a[ i ] = _mm_loadu_si128( ( const __m128i* ) &acc[ 2 * i ] );
+			for ( ; stripes; stripes--, in += stripe_length, secret += 8 ) {
+				for ( size_t i = 0; i != 4; i++ ) {
+					__m128i d = _mm_loadu_si128( ( const __m128i* ) ( in + 16 * i ) );
+					__m128i k = _mm_xor_si128( d, _mm_loadu_si128( ( const __m128i* ) ( secret + 16 * i ) ) );
+					a[ i ] = _mm_add_epi64( a[ i ], _mm_shuffle_epi32( d, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+					a[ i ] = _mm_add_epi64( a[ i ], _mm_mul_epu32( k, _mm_shuffle_epi32( k, _MM_SHUFFLE( 0, 3, 0, 1 ) ) ) );
+				}
+			}
+			for ( size_t i = 0; i != 4; i++ )
+				_mm_storeu_si128( ( __m128i* ) &acc[ 2 * i ], a[ i ] );
+#elif XSTD_XXH3_VECTOR >= 128 && ARM64_TARGET
+			uint64x2_t a[ 4 ];
+			for ( size_t i = 0; i != 4; i++ )
+				a[ i ] = vld1q_u64( &acc[ 2 * i ] );
+			for ( ; stripes; stripes--, in += stripe_length, secret += 8 ) {
+				for ( size_t i = 0; i != 4; i++ ) {
+					uint64x2_t d = vreinterpretq_u64_u8( vld1q_u8( in + 16 * i ) );
+					uint64x2_t k = veorq_u64( d, vreinterpretq_u64_u8( vld1q_u8( secret + 16 * i ) ) );
+					a[ i ] = vaddq_u64( a[ i ], vextq_u64( d, d, 1 ) );
+					a[ i ] = vmlal_u32( a[ i ], vmovn_u64( k ), vshrn_n_u64( k, 32 ) );
+				}
+			}
+			for ( size_t i = 0; i != 4; i++ )
+				vst1q_u64( &acc[ 2 * i ], a[ i ] );
+#else
+			for ( ; stripes; stripes--, in += stripe_length, secret += 8 )
+				accumulate_512( acc, in, secret );
+#endif
+		}
+		FORCE_INLINE static constexpr void accumulate( acc_type& acc, const uint8_t* in, const uint8_t* secret, size_t stripes ) {
+			if ( std::is_constant_evaluated() ) {
+				for ( ; stripes; stripes--, in += stripe_length, secret += 8 )
+					accumulate_512( acc, in, secret );
+			} else {
+				accumulate_vec( acc, in, secret, stripes );
+			}
+		}
+		FORCE_INLINE static constexpr void scramble( acc_type& acc, const uint8_t* secret ) {
+			for ( size_t i = 0; i != 8; i++ ) {
+				uint64_t v = acc[ i ];
+				v ^= v >> 47;
+				v ^= read64( secret + 8 * i );
+				acc[ i ] = v * traits32::prime_1;
+			}
+		}
+
+		// Consumes whole stripes, scrambling the accumulator at each block boundary.
+		//
+		FORCE_INLINE static constexpr void consume( acc_type& acc, size_t& stripe_count, const uint8_t* in, size_t stripes, const uint8_t* secret ) {
+			while ( stripes ) {
+				size_t count = std::min( stripes, stripes_per_block - stripe_count );
+				accumulate( acc, in, secret + stripe_count * 8, count );
+				in +=           count * stripe_length;
+				stripes -=      count;
+				stripe_count += count;
+				if ( stripe_count == stripes_per_block ) {
+					scramble( acc, secret + secret_length - stripe_length );
+					stripe_count = 0;
+				}
+			}
+		}
+		FORCE_INLINE static constexpr uint64_t merge( const acc_type& acc, const uint8_t* secret, uint64_t start ) {
+			for ( size_t i = 0; i != 4; i++ )
+				start += mul_fold( acc[ 2 * i ] ^ read64( secret + 16 * i ), acc[ 2 * i + 1 ] ^ read64( secret + 16 * i + 8 ) );
+			return avalanche( start );
+		}
+	};
+
+	// Streaming XXH3 implementation, Wide selects the 128-bit variant.
+	//
+	template<bool Wide>
+	struct basic_xxh3
+	{
+		using traits =     xxh3_traits;
+		using value_type = std::conditional_t<Wide, std::array<uint64_t, 2>, uint64_t>;
+		static constexpr size_t block_size =  traits::stripe_length;
+		static constexpr size_t digest_size = Wide ? 16 : 8;
+
+		// Hash state, the buffer holds the whole input until it overflows and afterwards the pending tail
+		// along with the last consumed stripe. acc is only live once the buffer has overflowed, or once
+		// finalized at which point it holds the digest.
+		//
+		size_t                                      input_length = 0;
+		size_t                                      stripe_count = 0;
+		size_t                                      buffered =     0;
+		uint64_t                                    seed;
+		traits::acc_type                            acc;
+		std::array<uint8_t, traits::buffer_length>  buffer;
+
+		// Seeded construction, the state is left uninitialized outside of constant evaluation so that
+		// short keys do not pay for it.
+		//
+		constexpr basic_xxh3( uint64_t seed = 0 ) noexcept
+			: seed{ seed } {
+			if ( std::is_constant_evaluated() ) {
+				acc =    {};
+				buffer = {};
+			}
+		}
+
+		// Default copy/move.
+		//
+		constexpr basic_xxh3( basic_xxh3&& ) noexcept = default;
+		constexpr basic_xxh3( const basic_xxh3& ) = default;
+		constexpr basic_xxh3& operator=( basic_xxh3&& ) noexcept = default;
+		constexpr basic_xxh3& operator=( const basic_xxh3& ) = default;
+
+		// Returns whether or not hash is finalized.
+		//
+		FORCE_INLINE constexpr bool finalized() const { return input_length == std::string::npos; }
+
+		// Appends the given array of bytes into the hash value.
+		//
+		FORCE_INLINE constexpr void add_bytes( const uint8_t* data, size_t n )
+		{
+			input_length += n;
+			assume( input_length != std::string::npos );
+
+			// Buffer if it fits.
+			//
+			if ( n <= ( buffer.size() - buffered ) ) {
+				if ( std::is_constant_evaluated() )
+					std::copy_n( data, n, buffer.data() + buffered );
+				else
+					memcpy( buffer.data() + buffered, data, n );
+				buffered += n;
+				return;
+			}
+			absorb( data, n );
+		}
+		constexpr void absorb( const uint8_t* data, size_t n )
+		{
+			traits::secret_type custom;
+			const uint8_t* secret = traits::default_secret.data();
+			if ( seed ) {
+				custom = traits::derive_secret( seed );
+				secret = custom.data();
+			}
+			auto state = ( input_length - n ) > buffer.size() ? acc : traits::default_acc;
+
+			// Complete and consume the buffer.
+			//
+			if ( buffered ) {
+				size_t count = buffer.size() - buffered;
+				if ( std::is_constant_evaluated() )
+					std::copy_n( data, count, buffer.data() + buffered );
+				else
+					memcpy( buffer.data() + buffered, data, count );
+				data += count;
+				n -=    count;
+				traits::consume( state, stripe_count, buffer.data(), buffer.size() / traits::stripe_length, secret );
+				buffered = 0;
+			}
+
+			// Consume whole stripes directly from the input, always leaving the last one behind and
+			// keeping a copy of the last consumed stripe at the end of the buffer for the digest.
+			//
+			if ( n > buffer.size() ) {
+				size_t stripes = ( n - 1 ) / traits::stripe_length;
+				traits::consume( state, stripe_count, data, stripes, secret );
+				data += stripes * traits::stripe_length;
+				n -=    stripes * traits::stripe_length;
+				if ( std::is_constant_evaluated() )
+					std::copy_n( data - traits::stripe_length, traits::stripe_length, buffer.end() - traits::stripe_length );
+				else
+					memcpy( buffer.data() + buffer.size() - traits::stripe_length, data - traits::stripe_length, traits::stripe_length );
+			}
+
+			// Buffer the remainder.
+			//
+			if ( std::is_constant_evaluated() )
+				std::copy_n( data, n, buffer.data() );
+			else
+				memcpy( buffer.data(), data, n );
+			buffered = n;
+			acc =      state;
+		}
+
+		// Appends the given trivial value as bytes into the hash value.
+		//
+		template<typename T>
+		FORCE_INLINE constexpr void add_bytes( const T& data ) noexcept
+		{
+			if ( std::is_constant_evaluated() )
+			{
+				using array_t = std::array<uint8_t, sizeof( T )>;
+				array_t arr = xstd::bit_cast< array_t >( data );
+				add_bytes( arr.data(), arr.size() );
+			}
+			else
+			{
+				add_bytes( ( const uint8_t* ) &data, sizeof( T ) );
+			}
+		}
+
+		// Update wrapper.
+		//
+		template<typename T>
+		FORCE_INLINE constexpr basic_xxh3& update(const T& data) noexcept { this->add_bytes<T>(data); return *this; };
+		FORCE_INLINE constexpr basic_xxh3& update(const uint8_t* data, size_t n) { this->add_bytes(data, n); return *this; }
+
+		// Computes the digest of the current state without modifying it.
+		//
+		FORCE_INLINE constexpr value_type compute() const noexcept
+		{
+			if ( input_length > traits::midsize_max ) [[unlikely]]
+				return compute_long();
+			if constexpr ( Wide )
+				return traits::hash_short_128( buffer.data(), input_length, seed );
+			else
+				return traits::hash_short_64( buffer.data(), input_length, seed );
+		}
+		NO_INLINE constexpr value_type compute_long() const noexcept
+		{
+			traits::secret_type custom;
+			const uint8_t* secret = traits::default_secret.data();
+			if ( seed ) {
+				custom = traits::derive_secret( seed );
+				secret = custom.data();
+			}
+
+			// Consume the buffered stripes on a copy of the state and accumulate the last stripe.
+			//
+			auto state = input_length > buffer.size() ? acc : traits::default_acc;
+			size_t count = stripe_count;
+			std::array<uint8_t, traits::stripe_length> last = {};
+			const uint8_t* last_stripe;
+			if ( buffered >= traits::stripe_length ) {
+				traits::consume( state, count, buffer.data(), ( buffered - 1 ) / traits::stripe_length, secret );
+				last_stripe = buffer.data() + buffered - traits::stripe_length;
+			} else {
+				size_t catchup = traits::stripe_length - buffered;
+				std::copy_n( buffer.end() - catchup, catchup, last.begin() );
+				std::copy_n( buffer.begin(), buffered, last.begin() + catchup );
+				last_stripe = last.data();
+			}
+			traits::accumulate_512( state, last_stripe, secret + traits::secret_length - traits::stripe_length - 7 );
+
+			uint64_t lo = traits::merge( state, secret + 11, input_length * traits::traits64::prime_1 );
+			if constexpr ( Wide ) {
+				uint64_t hi = traits::merge( state, secret + traits::secret_length - 64 - 11, ~( input_length * traits::traits64::prime_2 ) );
+				return { lo, hi };
+			} else {
+				return lo;
+			}
+		}
+
+		// Finalization of the hash.
+		//
+		FORCE_INLINE constexpr basic_xxh3& finalize() noexcept
+		{
+			if ( finalized() ) return *this;
+			if constexpr ( Wide ) {
+				auto result = compute();
+				acc[ 0 ] = result[ 0 ];
+				acc[ 1 ] = result[ 1 ];
+			} else {
+				acc[ 0 ] = compute();
+			}
+			input_length = std::string::npos;
+			return *this;
+		}
+		FORCE_INLINE constexpr value_type result() const noexcept
+		{
+			if constexpr ( Wide )
+				return { acc[ 0 ], acc[ 1 ] };
+			else
+				return acc[ 0 ];
+		}
+		FORCE_INLINE constexpr value_type digest() noexcept { return finalize().result(); }
+		FORCE_INLINE constexpr value_type digest() const noexcept
+		{
+			if ( finalized() ) [[likely]]
+				return result();
+			return compute();
+		}
+
+		// Explicit conversions, wide hashes truncate to the low half.
+		//
+		FORCE_INLINE constexpr uint64_t as64() const noexcept
+		{
+			if constexpr ( Wide )
+				return digest()[ 0 ];
+			else
+				return digest();
+		}
+		FORCE_INLINE constexpr uint32_t as32() const noexcept { return uint32_t( as64() ); }
+
+		// Implicit conversions.
+		//
+		constexpr operator uint64_t() const noexcept { return as64(); }
+		constexpr operator uint32_t() const noexcept { return as32(); }
+
+		// Conversion to human-readable format, in canonical big-endian order.
+		//
+		std::string to_string() const
+		{
+			if constexpr ( Wide ) {
+				auto v = digest();
+				return fmt::as_hex_string( std::array<uint64_t, 2>{ bswap( v[ 1 ] ), bswap( v[ 0 ] ) } );
+			} else {
+				return fmt::as_hex_string( bswap( digest() ) );
+			}
+		}
+
+		// Basic comparison operators.
+		//
+		constexpr bool operator<( const basic_xxh3& o ) const noexcept { return digest() < o.digest(); }
+		constexpr bool operator==( const basic_xxh3& o ) const noexcept { return digest() == o.digest(); }
+		constexpr bool operator!=( const basic_xxh3& o ) const noexcept { return digest() != o.digest(); }
+	};
+
+	// Define XXH3 64-bit and 128-bit.
+	//
+	using xxh3_64 =  basic_xxh3<false>;
+	using xxh3_128 = basic_xxh3<true>;
 };
 
 // Make it std::hashable.
@@ -355,4 +981,11 @@ namespace std
 			return ( size_t ) value.as64(); 
 		}
 	};
+	template<bool Wide>
+	struct hash<xstd::basic_xxh3<Wide>>
+	{
+		constexpr size_t operator()( const xstd::basic_xxh3<Wide>& value ) const { 
+			return ( size_t ) value.as64(); 
+		}
+	};
 };
\ No newline at end of file
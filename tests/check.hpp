@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal check helper for the regression tests, prints the failed expression and exits with failure.
+//
+#define CHECK( ... )                                                                                 \
+	do                                                                                               \
+	{                                                                                                \
+		if ( !( __VA_ARGS__ ) )                                                                      \
+		{                                                                                            \
+			fprintf( stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__VA_ARGS__ );      \
+			std::exit( 1 );                                                                          \
+		}                                                                                            \
+	} while ( 0 )
@@ -0,0 +1,86 @@
+#include <xstd/combinators.hpp>
+#include <stdexcept>
+#include <vector>
+#include "check.hpp"
+
+using namespace xstd;
+
+static job<int> value( int v )
+{
+	co_return v;
+}
+static job<int> raise()
+{
+	throw std::runtime_error( "child failure" );
+	co_return 0;
+}
+
+int main()
+{
+	// Exceptions thrown by children are rethrown to the parent instead of leaving it suspended.
+	//
+	auto all = []() -> job<int> {
+		try {
+			co_await when_all( value( 1 ), raise(), value( 3 ) );
+		} catch ( const std::runtime_error& ) {
+			co_return 1;
+		}
+		co_return 0;
+	};
+	CHECK( all().run() == 1 );
+
+	auto each = []() -> job<int> {
+		std::vector<int> items = { 1, 2, 3, 4, 5, 6 };
+		size_t visited = 0;
+		try {
+			co_await for_each_async( items, 2, [ & ]( int item ) -> job<int> {
+				visited++;
+				if ( item == 3 ) co_return co_await raise();
+				co_return item;
+			} );
+		} catch ( const std::runtime_error& ) {
+			co_return visited < items.size() ? 1 : 2;
+		}
+		co_return 0;
+	};
+	CHECK( each().run() == 1 );
+
+	// Runners that already finished are skipped when the rest are detached, the pending ones settle as cancelled.
+	//
+	for ( int i = 0; i != 100; i++ )
+	{
+		auto first = make_promise<int>();
+		auto second = make_promise<int>();
+		auto third = make_promise<int>();
+		first.resolve( 1 );
+		auto any = [ & ]() -> job<size_t> {
+			auto [ index, result ] = co_await when_any( first, second, third );
+			co_return index;
+		};
+		CHECK( any().run() == 0 );
+		second.resolve( 2 );
+		third.resolve( 3 );
+
+		std::vector<promise<int>> list = { make_promise<int>(), make_promise<int>(), make_promise<int>() };
+		list[ 1 ].resolve( 7 );
+		auto any_range = [ & ]() -> job<size_t> {
+			auto [ index, result ] = co_await when_any( list );
+			co_return index;
+		};
+		CHECK( any_range().run() == 1 );
+	}
+
+	// Over-aligned promises bypass the frame cache and keep their alignment.
+	//
+	{
+		struct alignas( 64 ) wide { int v; };
+		for ( int i = 0; i != 4; i++ )
+		{
+			auto pr = make_promise<wide>();
+			CHECK( ( uintptr_t( pr.ptr ) % 64 ) == 0 );
+			pr.resolve( wide{ i } );
+			auto small = make_promise<int>();
+			CHECK( ( uintptr_t( small.ptr ) % alignof( std::max_align_t ) ) == 0 );
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#include <xstd/event.hpp>
+#include <thread>
+#include <atomic>
+#include "check.hpp"
+
+int main()
+{
+	// Notify and reset without waiters.
+	//
+	xstd::event evt;
+	CHECK( !evt.peek() );
+	evt.notify();
+	CHECK( evt.peek() && evt.wait_for( 0 ) );
+	evt.notify();
+	evt.reset();
+	CHECK( !evt.peek() && !evt.wait_for( 1 ) );
+
+	// The waiter owns the event and frees it as soon as it is released, notify must not touch it afterwards.
+	//
+	for ( int i = 0; i != 2000; i++ )
+	{
+		auto* owned = new xstd::event();
+		std::atomic<bool> waiting = false;
+		std::thread waiter{ [ & ] {
+			waiting = true;
+			owned->wait();
+			delete owned;
+		} };
+		while ( !waiting )
+			std::this_thread::yield();
+		owned->notify();
+		waiter.join();
+	}
+
+#if defined(__linux__) && !defined(XSTD_OS_EVENT_PRIMITIVE)
+	// Waiters are released by a notify racing with a reset.
+	//
+	for ( int i = 0; i != 200; i++ )
+	{
+		xstd::event shared;
+		std::atomic<int> released = 0;
+		std::thread waiters[ 2 ] = {
+			std::thread{ [ & ] { shared.wait(); released++; } },
+			std::thread{ [ & ] { shared.wait(); released++; } },
+		};
+		while ( ( shared.primitive.word.load() & xstd::event_primitive::waiter_mask ) != 2 * xstd::event_primitive::waiter_one )
+			std::this_thread::yield();
+		shared.notify();
+		shared.reset();
+		for ( auto& t : waiters )
+			t.join();
+		CHECK( released == 2 );
+	}
+#endif
+}
@@ -0,0 +1,54 @@
+#include <xstd/event.hpp>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+// Cost of the event operations, best of 7 runs:
+// - notify+reset with no waiters, the uncontended fast path.
+// - notify on an already signalled event.
+// - ping-pong round trip between two threads, each side waking the other.
+//
+template<typename F>
+static double measure( size_t count, F&& fn )
+{
+	double best = 1e30;
+	for ( int i = 0; i != 7; i++ )
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		fn( count );
+		auto t1 = std::chrono::steady_clock::now();
+		best = std::min( best, std::chrono::duration<double, std::nano>( t1 - t0 ).count() / count );
+	}
+	return best;
+}
+
+int main()
+{
+	xstd::event evt;
+	printf( "notify+reset      %8.2f ns\n", measure( 1 << 22, [ & ]( size_t n ) {
+		for ( size_t i = 0; i != n; i++ ) { evt.notify(); evt.reset(); }
+	} ) );
+	evt.notify();
+	printf( "notify (set)      %8.2f ns\n", measure( 1 << 22, [ & ]( size_t n ) {
+		for ( size_t i = 0; i != n; i++ ) evt.notify();
+	} ) );
+
+	xstd::event ping, pong;
+	printf( "ping-pong         %8.2f ns\n", measure( 1 << 14, [ & ]( size_t n ) {
+		std::thread peer{ [ & ] {
+			for ( size_t i = 0; i != n; i++ ) {
+				ping.wait();
+				ping.reset();
+				pong.notify();
+			}
+		} };
+		for ( size_t i = 0; i != n; i++ ) {
+			ping.notify();
+			pong.wait();
+			pong.reset();
+		}
+		peer.join();
+	} ) );
+	return 0;
+}
@@ -0,0 +1,53 @@
+#include <xstd/hashable.hpp>
+#include <xstd/sha1.hpp>
+#include <xstd/sha256.hpp>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+// Throughput of make_hash over contiguous ranges, best of 7 runs:
+// - 1M x uint32_t, hashed as a single span.
+// - 512K x { int32 x = 0, y = 0 }, padding-free and hashed as a single span as of the bulk path.
+//
+struct point { int32_t x = 0, y = 0; };
+
+template<typename H, typename T>
+static double measure( const std::vector<T>& data )
+{
+	double best = 0;
+	for ( int i = 0; i != 7; i++ )
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		volatile auto h = xstd::make_hash<H>( data ).as64();
+		auto t1 = std::chrono::steady_clock::now();
+		( void ) h;
+		double gbps = ( data.size() * sizeof( T ) ) / std::chrono::duration<double, std::nano>( t1 - t0 ).count();
+		best = std::max( best, gbps );
+	}
+	return best;
+}
+
+template<typename H>
+static void run( const char* name, const std::vector<uint32_t>& u32, const std::vector<point>& pt )
+{
+	printf( "%-10s %6.2f GB/s %6.2f GB/s\n", name, measure<H>( u32 ), measure<H>( pt ) );
+}
+
+int main()
+{
+	std::vector<uint32_t> u32( 1 << 20 );
+	for ( size_t i = 0; i != u32.size(); i++ )
+		u32[ i ] = uint32_t( i * 0x9E3779B9 );
+	std::vector<point> pt( 1 << 19 );
+	for ( size_t i = 0; i != pt.size(); i++ )
+		pt[ i ] = { int32_t( i ), int32_t( ~i ) };
+
+	printf( "%-10s %11s %11s\n", "hasher", "u32", "pt" );
+	run<xstd::xcrc>( "xcrc", u32, pt );
+	run<xstd::crc32>( "crc32", u32, pt );
+	run<xstd::fnv64>( "fnv64", u32, pt );
+	run<xstd::xxhash64>( "xxhash64", u32, pt );
+	run<xstd::sha1>( "sha1", u32, pt );
+	run<xstd::sha256>( "sha256", u32, pt );
+	return 0;
+}
@@ -0,0 +1,52 @@
+#include <xstd/hashable.hpp>
+#include <vector>
+#include <array>
+#include "check.hpp"
+
+struct point { int32_t x = 0, y = 0; };
+
+int main()
+{
+	// Element types with their own hasher must not be hashed as raw bytes.
+	//
+	static_assert( !xstd::impl::RawHashable<xstd::hash_t, std::optional<int>> );
+	static_assert( !xstd::impl::RawHashable<xstd::hash_t, std::variant<int, float>> );
+	static_assert( !xstd::impl::RawHashable<xstd::hash_t, std::reference_wrapper<int>> );
+	static_assert( !xstd::impl::RawHashable<xstd::hash_t, std::pair<int, int>> );
+	static_assert( !xstd::impl::RawHashable<xstd::hash_t, std::array<int, 4>> );
+	static_assert( !xstd::impl::RawHashable<xstd::hash_t, const char*> );
+	static_assert( xstd::impl::BulkHashable<xstd::hash_t, point> );
+	static_assert( xstd::impl::BulkHashable<xstd::hash_t, uint32_t> );
+
+	// Disengaged payload bytes must not leak into the hash.
+	//
+	std::vector<std::optional<int>> o1 = { 1, std::nullopt, 3 };
+	std::vector<std::optional<int>> o2 = { 1, 5, 3 };
+	o2[ 1 ].reset();
+	CHECK( xstd::make_hash( o1 ) == xstd::make_hash( o2 ) );
+	CHECK( xstd::make_hash( std::vector<std::optional<int>>{ 1 } ) != xstd::make_hash( std::vector<std::optional<int>>{ std::nullopt } ) );
+
+	// Variants hash the index and the active member only.
+	//
+	std::vector<std::variant<int, double>> v1 = { 1, 2.0 };
+	std::vector<std::variant<int, double>> v2 = { 1.0, 1 };
+	v2[ 0 ] = 1;
+	v2[ 1 ] = 2.0;
+	CHECK( xstd::make_hash( v1 ) == xstd::make_hash( v2 ) );
+
+	// Reference wrappers hash the referenced values rather than their addresses.
+	//
+	int a = 7, b = 7;
+	std::vector<std::reference_wrapper<int>> r1 = { a };
+	std::vector<std::reference_wrapper<int>> r2 = { b };
+	CHECK( xstd::make_hash( r1 ) == xstd::make_hash( r2 ) );
+
+	// Padding-free types still take the bulk path and match the element-wise digest.
+	//
+	std::vector<point> p = { { 1, 2 }, { 3, 4 } };
+	xstd::hash_t h = {};
+	for ( auto& e : p )
+		h.add_bytes( e );
+	CHECK( xstd::make_hash( p ) == h );
+	return 0;
+}
@@ -0,0 +1,128 @@
+#include <xstd/http.hpp>
+#include <string>
+#include <stdexcept>
+#include "check.hpp"
+
+using namespace xstd;
+
+int main()
+{
+	// Chunked heads drop the framing headers set by the user.
+	//
+	http::response res{ 200 };
+	res.set_header( "Content-Length", "5" );
+	res.set_header( "X-Test", "1" );
+	vec_buffer head = {};
+	res.write_head( head );
+	std::string text{ (const char*) head.data(), head.size() };
+	CHECK( text.find( "Content-Length" ) == std::string::npos );
+	CHECK( text.find( "X-Test: 1\r\n" ) != std::string::npos );
+	CHECK( text.find( "Transfer-Encoding: chunked\r\n\r\n" ) != std::string::npos );
+
+	http::request req{ http::POST, "/" };
+	req.set_header( "content-length", "5" );
+	head.clear();
+	req.write_head( head );
+	text = std::string{ (const char*) head.data(), head.size() };
+	CHECK( text.find( "content-length" ) == std::string::npos );
+	CHECK( text.find( "Transfer-Encoding: chunked\r\n\r\n" ) != std::string::npos );
+
+	// A streamed body written from a source reads back piece by piece through a sink.
+	//
+	stream mem = {};
+	res.body_source = []( http::body::chunked_writer& writer ) -> job<bool> {
+		co_await writer.write( std::span{ (const uint8_t*) "hello ", 6 } );
+		co_await writer.write( std::span{ (const uint8_t*) "world", 5 } );
+		co_return true;
+	};
+	CHECK( res.send( &mem ).run() );
+
+	http::response out = {};
+	CHECK( out.read_head( &mem ).run() );
+	CHECK( out.status == 200 && out.body_props.code == http::body::chunked );
+	std::string received;
+	size_t pieces = 0;
+	auto reader = out.body_reader( &mem );
+	bool ok = reader.pipe( [ & ]( std::span<const uint8_t> piece ) -> job<bool> {
+		received.append( (const char*) piece.data(), piece.size() );
+		pieces++;
+		co_return true;
+	} ).run();
+	CHECK( ok && reader.done() && !reader.failed() );
+	CHECK( received == "hello world" && pieces == 2 );
+
+	// A rejecting sink stops the transfer.
+	//
+	CHECK( res.send( &mem ).run() );
+	http::response rejected = {};
+	CHECK( rejected.read_head( &mem ).run() );
+	auto reader2 = rejected.body_reader( &mem );
+	ok = reader2.pipe( []( std::span<const uint8_t> ) -> job<bool> { co_return false; } ).run();
+	CHECK( !ok );
+
+	// Parsed heads are adopted as the header storage, falling back to merging for duplicates and irregular spacing.
+	//
+	std::string_view raw_head = "GET /a HTTP/1.1\r\nHost: x\r\nSet-Cookie: a=1\r\nSet-Cookie: b=2\r\n\r\nbody";
+	vec_buffer raw{ std::span{ (const uint8_t*) raw_head.data(), raw_head.size() } };
+	http::request parsed = {};
+	CHECK( !parsed.parse_head( raw ) );
+	CHECK( raw.size() == 4 && parsed.path == "/a" && parsed.headers.size() == 3 );
+	auto host = parsed.headers.get( "host" );
+	CHECK( host == "x" && (const uint8_t*) host.data() == parsed.headers.data.data() + 23 );
+	CHECK( parsed.headers.list( "set-cookie" ).size() == 2 );
+
+	raw_head = "GET / HTTP/1.1\r\nAccept: a\r\naccept:b  \r\n\r\n";
+	raw = vec_buffer{ std::span{ (const uint8_t*) raw_head.data(), raw_head.size() } };
+	parsed = {};
+	CHECK( !parsed.parse_head( raw ) );
+	CHECK( raw.empty() && parsed.headers.size() == 1 && parsed.headers.get( "Accept" ) == "a, b" );
+
+#if XSTD_HAS_TCP
+	// Streaming handlers, response sources, request sources and response sinks round trip over a loopback connection.
+	//
+	http::agent::make_global<http::basic_agent>();
+	http::server srv{ net::ipv4{ 127, 0, 0, 1 }, 18089, []( http::request req, http::body::reader& body ) -> job<http::response> {
+		if ( req.path == "/throw" )
+			throw std::runtime_error( "handler failure" );
+		auto echo = std::make_shared<std::string>();
+		http::body::sink collect = [ = ]( std::span<const uint8_t> piece ) -> job<bool> {
+			echo->append( (const char*) piece.data(), piece.size() );
+			co_return true;
+		};
+		co_await body.pipe( collect );
+		http::response res{ 200 };
+		res.body_source = [ = ]( http::body::chunked_writer& writer ) -> job<bool> {
+			co_await writer.write( std::span{ (const uint8_t*) echo->data(), echo->size() } );
+			co_return true;
+		};
+		co_return res;
+	} };
+	CHECK( srv.listen() );
+	for ( int i = 0; i != 2; i++ )
+	{
+		std::string echoed;
+		auto reply = http::post( "http://127.0.0.1:18089/", {
+			.body_source = []( http::body::chunked_writer& writer ) -> job<bool> {
+				co_await writer.write( std::span{ (const uint8_t*) "ping", 4 } );
+				co_return true;
+			},
+			.body_sink = [ & ]( std::span<const uint8_t> piece ) -> job<bool> {
+				echoed.append( (const char*) piece.data(), piece.size() );
+				co_return true;
+			},
+		} ).run( true );
+		CHECK( reply.ok() && reply.body.empty() && echoed == "ping" );
+	}
+
+	// A throwing handler is answered with a 500 closing the connection, later requests are still served.
+	//
+	auto failure = http::get( "http://127.0.0.1:18089/throw" ).run( true );
+	CHECK( failure.status == 500 && !failure.keep_alive() );
+	CHECK( http::post( "http://127.0.0.1:18089/", { .body = vec_buffer{ std::span{ (const uint8_t*) "ok", 2 } } } ).run( true ).body.size() == 2 );
+
+	// Skip the static destructors, the socket threads may still be winding down.
+	//
+	std::fflush( stdout );
+	std::_Exit( 0 );
+#endif
+}
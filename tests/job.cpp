@@ -0,0 +1,36 @@
+#include <xstd/job.hpp>
+#include <stdexcept>
+#include "check.hpp"
+
+using namespace xstd;
+
+static job<int> fail()
+{
+	throw std::runtime_error( "failure" );
+	co_return 0;
+}
+static job<> fail_void()
+{
+	throw std::runtime_error( "failure" );
+	co_return;
+}
+static job<int> catcher()
+{
+	int caught = 0;
+	try { co_await fail(); } catch ( const std::runtime_error& ) { caught++; }
+	try { co_await fail_void(); } catch ( const std::runtime_error& ) { caught++; }
+	co_return caught;
+}
+
+int main()
+{
+	// Exceptions reach the awaiting coroutine, and the caller of run otherwise.
+	//
+	CHECK( catcher().run() == 2 );
+	bool thrown = false;
+	try { fail().run(); } catch ( const std::runtime_error& ) { thrown = true; }
+	CHECK( thrown );
+	thrown = false;
+	try { fail_void().run(); } catch ( const std::runtime_error& ) { thrown = true; }
+	CHECK( thrown );
+}
@@ -0,0 +1,35 @@
+#include <xstd/serialization.hpp>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+int main()
+{
+	// Byte-aligned views reference the stream whatever precedes them.
+	//
+	std::vector<uint8_t> bytes = { 1, 2, 3 };
+	for ( size_t pad = 0; pad != 4; pad++ )
+	{
+		auto buf = xstd::serialize( std::make_tuple( std::string( pad, 'x' ), std::span<const uint8_t>{ bytes }, std::string_view{ "view" } ) );
+		auto [ prefix, span, view ] = xstd::deserialize<std::tuple<std::string, std::span<const uint8_t>, std::string_view>>( buf );
+		CHECK( prefix.size() == pad );
+		CHECK( std::vector<uint8_t>( span.begin(), span.end() ) == bytes );
+		CHECK( view == "view" );
+	}
+
+	// Wider elements written as views read back through owning containers and serialized views at any offset.
+	//
+	std::vector<uint32_t> words = { 1, 0x12345678, 3 };
+	for ( size_t pad = 0; pad != 4; pad++ )
+	{
+		auto buf = xstd::serialize( std::make_tuple( std::string( pad, 'x' ), std::span<const uint32_t>{ words } ) );
+		auto owned = std::get<1>( xstd::deserialize<std::tuple<std::string, std::vector<uint32_t>>>( buf ) );
+		CHECK( owned == words );
+
+		auto lazy = std::get<1>( xstd::deserialize<std::tuple<std::string, xstd::serialized_view<std::vector<uint32_t>>>>( buf ) );
+		CHECK( lazy.size() == words.size() );
+		CHECK( lazy[ 1 ] == words[ 1 ] );
+		CHECK( lazy.materialize() == words );
+	}
+	return 0;
+}